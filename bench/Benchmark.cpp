@@ -0,0 +1,249 @@
+// Benchmark.cpp
+// Micro and end-to-end benchmarks over the data/GameP*.txt boards, in the
+// style of Google Benchmark: each case is run in a loop until it has taken
+// --min-time seconds, then reported per operation.
+//
+// Usage: unblockme_bench [--data DIR] [--filter SUBSTR] [--min-time S]
+//                        [--repetitions N] [--out FILE] [--baseline FILE]
+//                        [--tolerance F]
+// --out writes the results as JSON; --baseline compares against such a file
+// and exits with 1 if any case is more than `tolerance` (default 0.25) slower.
+#include "Game.hpp"
+#include "State.hpp"
+#include "Search.hpp"
+#include "PuzzleIO.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+// ======== Allocation counter ======== //
+// Replaces the global operator new so every heap allocation is counted.
+// GCC flags the malloc/free pairing inside the replacements themselves.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+static std::atomic<std::size_t> allocations(0);
+
+void* operator new(std::size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// ======== Benchmark registry ======== //
+// `run` performs one operation and returns the number of states it expanded
+// (0 for micro benchmarks).
+struct Benchmark {
+    std::string name;
+    std::function<std::size_t()> run;
+};
+
+struct Result {
+    std::string name;
+    double ns_per_op = 0;
+    std::size_t iterations = 0;
+    double nodes_per_second = 0;
+    double allocs_per_op = 0;
+    double allocs_per_expansion = 0;
+};
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static Result run_once(const Benchmark& b, std::size_t iterations) {
+    Result r;
+    r.name = b.name;
+    std::size_t nodes = 0;
+    std::size_t allocs_before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; i++) nodes += b.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::size_t allocs = allocations.load() - allocs_before;
+    r.iterations = iterations;
+    r.ns_per_op = seconds * 1e9 / iterations;
+    r.nodes_per_second = nodes && seconds > 0 ? nodes / seconds : 0;
+    r.allocs_per_op = double(allocs) / iterations;
+    r.allocs_per_expansion = nodes ? double(allocs) / nodes : 0;
+    return r;
+}
+
+// Grows the iteration count until one run takes min_time, then repeats that
+// run and keeps the median, which is far less noisy than a single sample.
+static Result measure(const Benchmark& b, double min_time, int repetitions) {
+    std::size_t iterations = 1;
+    Result r = run_once(b, iterations);
+    while (r.ns_per_op * iterations < min_time * 1e9 && iterations < (std::size_t(1) << 30)) {
+        // Aim a little past min_time, as Google Benchmark does.
+        double factor = r.ns_per_op > 0 ? 1.4 * min_time * 1e9 / (r.ns_per_op * iterations) : 10;
+        iterations = static_cast<std::size_t>(iterations * std::min(std::max(factor, 2.0), 100.0));
+        r = run_once(b, iterations);
+    }
+    std::vector<Result> runs{r};
+    for (int k = 1; k < repetitions; k++) runs.push_back(run_once(b, iterations));
+    std::sort(runs.begin(), runs.end(), [](const Result& x, const Result& y) { return x.ns_per_op < y.ns_per_op; });
+    return runs[runs.size() / 2];
+}
+
+// ======== JSON baseline ======== //
+// One result per line so the baseline can be read back without a JSON library.
+static void write_json(const std::vector<Result>& results, const std::string& path) {
+    std::ofstream out(path);
+    out << "{\n  \"peak_rss_kb\": " << peak_rss_kb() << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.ns_per_op
+            << ", \"iterations\": " << r.iterations << ", \"nodes_per_second\": " << r.nodes_per_second
+            << ", \"allocs_per_op\": " << r.allocs_per_op << ", \"allocs_per_expansion\": "
+            << r.allocs_per_expansion << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static std::map<std::string, double> read_baseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t name = line.find("\"name\": \"");
+        size_t ns = line.find("\"ns_per_op\": ");
+        if (name == std::string::npos || ns == std::string::npos) continue;
+        name += 9;
+        baseline[line.substr(name, line.find('"', name) - name)] = std::atof(line.c_str() + ns + 13);
+    }
+    return baseline;
+}
+
+// ======== Cases ======== //
+static std::vector<Benchmark> make_benchmarks(const std::string& data_dir, std::vector<Game>& games,
+                                              std::vector<std::string>& names) {
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(data_dir)) {
+        if (entry.path().extension() == ".txt") files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    std::vector<std::string> paths;
+    for (const auto& path : files) {
+        Game g;
+        if (!load_puzzle(path, g)) continue;
+        games.push_back(g);
+        names.push_back(std::filesystem::path(path).stem().string());
+        paths.push_back(path);
+    }
+
+    std::vector<Benchmark> benchmarks;
+    for (size_t i = 0; i < games.size(); i++) {
+        Game* g = &games[i];
+        const std::string& name = names[i];
+        std::size_t bfs_nodes = 0, astar_nodes = 0;
+        SearchStats stats;
+        bfs_shortest_path(*g, &stats);
+        bfs_nodes = stats.expanded;
+        astar_shortest_path(*g, "blocking_cars", &stats);
+        astar_nodes = stats.expanded;
+
+        benchmarks.push_back({"load_puzzle/" + name, [path = paths[i]]() {
+            Game loaded;
+            load_puzzle(path, loaded);
+            return std::size_t(0);
+        }});
+        benchmarks.push_back({"Game::update_free/" + name, [g]() { g->update_free(); return std::size_t(0); }});
+        benchmarks.push_back({"Game::GameHash/" + name, [g]() {
+            volatile size_t h = Game::GameHash()(*g);
+            (void)h;
+            return std::size_t(0);
+        }});
+        benchmarks.push_back({"State::next_States/" + name, [g]() {
+            State s(*g);
+            return s.next_States().empty() ? std::size_t(0) : std::size_t(1);
+        }});
+        auto state = std::make_shared<State>(*g);
+        benchmarks.push_back({"State::for_each_move/" + name, [state]() {
+            std::size_t count = 0;
+            state->for_each_move([&](int, int) { count++; });
+            return count ? std::size_t(1) : std::size_t(0);
+        }});
+        benchmarks.push_back({"State::shortest_path/" + name, [g, bfs_nodes]() {
+            State s(*g);
+            s.shortest_path();
+            return bfs_nodes;
+        }});
+        benchmarks.push_back({"State::shortest_path_with_heuristic:blocking_cars/" + name, [g, astar_nodes]() {
+            State s(*g);
+            s.shortest_path_with_heuristic("blocking_cars");
+            return astar_nodes;
+        }});
+    }
+    return benchmarks;
+}
+
+// ======== main ======== //
+int main(int argc, char* argv[]) {
+    std::string data_dir = "data", filter, out_path, baseline_path;
+    double min_time = 0.05, tolerance = 0.25;
+    int repetitions = 3;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--data") == 0 && i + 1 < argc) data_dir = argv[++i];
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) min_time = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baseline_path = argv[++i];
+        else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) tolerance = std::atof(argv[++i]);
+        else {
+            std::cerr << "Unknown option: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<Game> games;
+    std::vector<std::string> names;
+    games.reserve(1024);
+    std::vector<Benchmark> benchmarks = make_benchmarks(data_dir, games, names);
+    std::map<std::string, double> baseline;
+    if (!baseline_path.empty()) baseline = read_baseline(baseline_path);
+
+    std::printf("%-60s %14s %12s %14s %12s\n", "Benchmark", "Time", "Iterations", "nodes/s", "allocs/exp");
+    std::vector<Result> results;
+    int regressions = 0;
+    for (const auto& b : benchmarks) {
+        if (!filter.empty() && b.name.find(filter) == std::string::npos) continue;
+        Result r = measure(b, min_time, repetitions);
+        results.push_back(r);
+        std::printf("%-60s %11.0f ns %12zu %14.0f %12.2f", r.name.c_str(), r.ns_per_op, r.iterations,
+                    r.nodes_per_second, r.allocs_per_expansion);
+        auto it = baseline.find(r.name);
+        if (it != baseline.end() && r.ns_per_op > it->second * (1 + tolerance)) {
+            std::printf("  REGRESSION (baseline %.0f ns)", it->second);
+            regressions++;
+        }
+        std::printf("\n");
+    }
+    std::printf("Peak RSS: %ld kB\n", peak_rss_kb());
+
+    if (!out_path.empty()) write_json(results, out_path);
+    if (regressions) {
+        std::printf("%d regression(s) beyond %.0f%%\n", regressions, tolerance * 100);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+// LoadTest.cpp
+// Load test of the solvers: replays a set of boards, generated from a seed
+// (see Generator.hpp) or read from a puzzle pack, through a pool of workers at
+// a fixed arrival rate, once per solver, and reports the latency percentiles
+// and the throughput of each.
+//
+// Usage: unblockme_loadtest [--pack FILE | --count N --size N --cars N
+//                            --min-moves N --max-moves N --seed S --max-states N]
+//                           [--solvers LIST] [--rate R] [--jobs N]
+//                           [--max-memory MB] [--out FILE]
+// --solvers is a comma-separated list of solver names as in --batch (default
+// bfs,bidirectional,astar:blocking_cars). --rate is in boards per second; 0
+// (the default) sends each board as soon as a worker is free. --out writes
+// the results as JSON. The exit code is 1 if a solver disagrees on the
+// number of moves of a board.
+#include "Game.hpp"
+#include "Search.hpp"
+#include "PuzzleIO.hpp"
+#include "Generator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::string solver;
+    std::size_t boards = 0;
+    std::size_t mismatches = 0; // boards whose number of moves differs from the expected one
+    double seconds = 0;         // first arrival to last answer
+    double throughput = 0;      // boards per second
+    double mean_ms = 0, p50_ms = 0, p99_ms = 0, max_ms = 0;
+};
+
+// Nearest-rank percentile of sorted values.
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    std::size_t rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+
+// ======== Replay ======== //
+// Board k arrives at start + k / rate. A worker takes the boards in order and
+// waits for the arrival time if it is early; the latency runs from the
+// arrival to the answer, so the time a board waits for a free worker counts
+// as well, as it would for a client. With no rate a board arrives when a
+// worker takes it, and the latency is the solving time alone.
+static Result replay(const std::vector<Game>& games, std::vector<int>& expected, const std::string& solver,
+                     double rate, int jobs, std::size_t max_memory) {
+    Result r;
+    r.solver = solver;
+    r.boards = games.size();
+    std::vector<double> latency(games.size());
+    std::vector<int> moves(games.size());
+    std::atomic<std::size_t> taken{0};
+    Clock::time_point start = Clock::now();
+
+    auto work = [&]() {
+        SearchWorkspace workspace;
+        for (std::size_t k; (k = taken++) < games.size();) {
+            Clock::time_point arrival = Clock::now();
+            if (rate > 0) {
+                arrival = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(k / rate));
+                std::this_thread::sleep_until(arrival);
+            }
+            moves[k] = static_cast<int>(solve(games[k], solver, nullptr, max_memory, &workspace).size());
+            latency[k] = std::chrono::duration<double, std::milli>(Clock::now() - arrival).count();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < jobs; t++) workers.emplace_back(work);
+    for (auto& th : workers) th.join();
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // The first solver sets the expected answers of boards read from a pack.
+    if (expected.empty()) expected = moves;
+    for (std::size_t k = 0; k < games.size(); k++) {
+        if (moves[k] != expected[k]) r.mismatches++;
+    }
+    r.throughput = r.seconds > 0 ? games.size() / r.seconds : 0;
+    std::sort(latency.begin(), latency.end());
+    for (double l : latency) r.mean_ms += l;
+    r.mean_ms = latency.empty() ? 0 : r.mean_ms / latency.size();
+    r.p50_ms = percentile(latency, 0.50);
+    r.p99_ms = percentile(latency, 0.99);
+    r.max_ms = latency.empty() ? 0 : latency.back();
+    return r;
+}
+
+static void write_json(const std::vector<Result>& results, double rate, int jobs, const std::string& path) {
+    std::ofstream out(path);
+    out << "{\n  \"rate\": " << rate << ",\n  \"jobs\": " << jobs << ",\n  \"solvers\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << "    {\"solver\": \"" << r.solver << "\", \"boards\": " << r.boards << ", \"mismatches\": "
+            << r.mismatches << ", \"seconds\": " << r.seconds << ", \"throughput\": " << r.throughput
+            << ", \"mean_ms\": " << r.mean_ms << ", \"p50_ms\": " << r.p50_ms << ", \"p99_ms\": " << r.p99_ms
+            << ", \"max_ms\": " << r.max_ms << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// ======== main ======== //
+int main(int argc, char* argv[]) {
+    GeneratorOptions generator;
+    std::size_t count = 1000;
+    std::string pack_path, out_path, solver_list = "bfs,bidirectional,astar:blocking_cars";
+    double rate = 0;
+    int jobs = 1;
+    std::size_t max_memory = IDA_DEFAULT_MEMORY;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc) pack_path = argv[++i];
+        else if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) generator.size = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--cars") == 0 && i + 1 < argc) generator.cars = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--min-moves") == 0 && i + 1 < argc) generator.min_moves = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-moves") == 0 && i + 1 < argc) generator.max_moves = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) generator.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--max-states") == 0 && i + 1 < argc) generator.max_states = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--solvers") == 0 && i + 1 < argc) solver_list = argv[++i];
+        else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) rate = std::max(0.0, std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) jobs = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-memory") == 0 && i + 1 < argc) max_memory = std::strtoull(argv[++i], nullptr, 10) << 20;
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+        else {
+            std::cerr << "Unknown option: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    if (jobs <= 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> solvers;
+    std::stringstream list(solver_list);
+    for (std::string name; std::getline(list, name, ',');) {
+        if (!is_solver_name(name)) {
+            std::cerr << "Unknown solver: " << name << "\n";
+            return 1;
+        }
+        solvers.push_back(name);
+    }
+
+    std::vector<Game> games;
+    std::vector<int> expected;
+    auto start = Clock::now();
+    if (!pack_path.empty()) {
+        PuzzlePack pack;
+        if (!pack.open(pack_path)) {
+            std::cerr << "Error opening puzzle pack: " << pack_path << "\n";
+            return 1;
+        }
+        for (std::size_t k = 0; k < pack.size(); k++) {
+            Game g;
+            if (!pack.get(k, g)) {
+                std::cerr << "Invalid board " << k << " in " << pack_path << "\n";
+                return 1;
+            }
+            games.push_back(g);
+        }
+    } else {
+        generator.jobs = jobs;
+        std::string error = check_generator_options(generator);
+        if (!error.empty() || !generate_puzzles(generator, count, games, &expected)) {
+            std::cerr << "Error generating boards: " << (error.empty() ? "too few in range" : error) << "\n";
+            return 1;
+        }
+    }
+    std::printf("%zu boards (%s, %.2f s), %d workers, ", games.size(),
+                pack_path.empty() ? ("seed " + std::to_string(generator.seed)).c_str() : pack_path.c_str(),
+                std::chrono::duration<double>(Clock::now() - start).count(), jobs);
+    if (rate > 0) std::printf("%g boards/s\n", rate);
+    else std::printf("unlimited rate\n");
+
+    std::vector<Result> results;
+    std::printf("%-28s %10s %10s %10s %10s %12s %10s\n", "solver", "mean ms", "p50 ms", "p99 ms", "max ms",
+                "boards/s", "mismatches");
+    bool agree = true;
+    for (const auto& solver : solvers) {
+        Result r = replay(games, expected, solver, rate, jobs, max_memory);
+        std::printf("%-28s %10.3f %10.3f %10.3f %10.3f %12.1f %10zu\n", r.solver.c_str(), r.mean_ms, r.p50_ms,
+                    r.p99_ms, r.max_ms, r.throughput, r.mismatches);
+        agree = agree && r.mismatches == 0;
+        results.push_back(r);
+    }
+    if (!out_path.empty()) write_json(results, rate, jobs, out_path);
+    return agree ? 0 : 1;
+}
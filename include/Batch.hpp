@@ -0,0 +1,34 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// ======== Batch mode ======== //
+// Solves many puzzle files without prompts. Each input is a puzzle file, a
+// directory (every *.txt inside, sorted), a glob pattern or a puzzle pack
+// (PuzzleIO.hpp), whose boards are named "pack#i". Boards are handed
+// out one at a time to `jobs` worker threads and one line per board is written
+// to `out` as soon as it is solved, so lines are in completion order.
+struct BatchOptions {
+    std::vector<std::string> inputs;
+    std::string solver = "bfs";
+    std::string format = "json"; // "json" or "csv"
+    int jobs = 1;
+    std::size_t max_memory = 0; // bytes for each IDA* transposition table, 0 = default
+    std::string pdb_path;       // pattern database for "pattern_database", mapped by each worker
+};
+
+// Puzzle files named by the inputs; unreadable patterns are reported on cerr.
+std::vector<std::string> expand_inputs(const std::vector<std::string>& inputs);
+
+// s as the body of a JSON string: quotes, backslashes and control
+// characters escaped. Also used for the answers of --serve.
+std::string json_escape(const std::string& s);
+
+// Returns the number of boards that could not be read or solved.
+int run_batch(const BatchOptions& options, std::ostream& out);
+
+#endif
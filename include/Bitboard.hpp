@@ -0,0 +1,234 @@
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+#include "Game.hpp"
+#include <cstdint>
+
+// ======== Mask helpers ======== //
+// Cells are numbered r * size + c in the row-major mask and c * size + r in the
+// transposed one, so every lane (a row, or a column once transposed) is a run
+// of `size` consecutive bits.
+
+inline bool mask_test(std::uint64_t m, int bit) { return (m >> bit) & 1u; }
+inline bool mask_test(const WideMask& m, int bit) { return m.test(bit); }
+
+inline bool mask_any(std::uint64_t m) { return m != 0; }
+inline bool mask_any(const WideMask& m) { return m.any(); }
+
+inline unsigned mask_lane(std::uint64_t m, int offset, int size) {
+    return static_cast<unsigned>(m >> offset) & ((1u << size) - 1);
+}
+inline unsigned mask_lane(const WideMask& m, int offset, int size) {
+    return static_cast<unsigned>(((m >> offset) & WideMask((1u << size) - 1)).to_ulong());
+}
+
+template <typename Mask>
+Mask mask_shift(const Mask& m, int n) {
+    return n >= 0 ? (m << n) : (m >> -n);
+}
+
+// ======== Moves ======== //
+// One slide: car index and signed distance along its lane.
+struct Move {
+    std::int8_t car;
+    std::int8_t delta;
+};
+
+// Upper bound on the slides of one layout: each car has at most size - 1
+// other positions in its lane.
+constexpr int MAX_MOVES = MAX_CARS * (MAX_SIZE - 1);
+
+// ======== Bitboard ======== //
+// Compact occupancy for the search engine. Each car slides along a single lane
+// (its row if horizontal, its column if vertical); pos is the 0-based index of
+// its first cell in that lane. Nothing here touches the heap.
+//
+// Size fixes the board dimension at compile time (0 = read from the Game), so
+// lane masks, bounds and strides become constants; Cars bounds the per-car
+// arrays.
+template <typename Mask, int Size = 0, int Cars = MAX_CARS>
+class BasicBitboard {
+public:
+    using mask_type = Mask;
+    static constexpr int fixed_size = Size;
+    static constexpr int max_cars = Cars;
+
+    int size = Size;
+    int nbCars = 0;
+    Mask occupied{};   // row-major
+    Mask occupied_t{}; // column-major
+    bool horiz[Cars];
+    std::int8_t lengths[Cars];
+    std::int8_t lane[Cars];
+    std::int8_t pos[Cars];
+    Mask cells[Cars];   // car cells in occupied
+    Mask cells_t[Cars]; // car cells in occupied_t
+    Mask home[Cars];    // cells[i] with the car at pos 0
+    Mask home_t[Cars];  // cells_t[i] with the car at pos 0
+
+    // Board dimension; a constant when Size is set.
+    int dim() const { return Size ? Size : size; }
+
+    // Builds the board from a Game; false if the layout does not fit or overlaps.
+    bool load(const Game& g) {
+        if (g.size < 1 || g.size * g.size > static_cast<int>(sizeof(Mask) * 8) || (Size && g.size != Size) ||
+            g.nbCars < 1 || g.nbCars > Cars ||
+            static_cast<int>(g.positions.size()) < g.nbCars) return false;
+        size = g.size;
+        nbCars = g.nbCars;
+        occupied = Mask{};
+        occupied_t = Mask{};
+        for (int i = 0; i < nbCars; i++) {
+            horiz[i] = g.horiz[i];
+            lengths[i] = static_cast<std::int8_t>(g.lengths[i]);
+            lane[i] = static_cast<std::int8_t>(horiz[i] ? g.positions[i][1] - 1 : g.positions[i][0] - 1);
+            pos[i] = static_cast<std::int8_t>(horiz[i] ? g.positions[i][0] - 1 : g.positions[i][1] - 1);
+            if (lane[i] < 0 || lane[i] >= dim() || pos[i] < 0 || lengths[i] < 1 ||
+                pos[i] + lengths[i] > dim()) return false;
+            cells[i] = Mask{};
+            cells_t[i] = Mask{};
+            for (int k = pos[i]; k < pos[i] + lengths[i]; k++) {
+                int bit = horiz[i] ? lane[i] * dim() + k : k * dim() + lane[i];
+                int bit_t = horiz[i] ? k * dim() + lane[i] : lane[i] * dim() + k;
+                if (mask_test(occupied, bit)) return false;
+                cells[i] |= Mask(1) << bit;
+                cells_t[i] |= Mask(1) << bit_t;
+                occupied |= Mask(1) << bit;
+                occupied_t |= Mask(1) << bit_t;
+            }
+            home[i] = mask_shift(cells[i], -pos[i] * stride(i));
+            home_t[i] = mask_shift(cells_t[i], -pos[i] * stride_t(i));
+        }
+        return true;
+    }
+
+    // Places every car at the coordinate stored in k, keeping lanes and lengths.
+    void load_key(const StateKey& k) {
+        occupied = Mask{};
+        occupied_t = Mask{};
+        for (int i = 0; i < nbCars; i++) {
+            pos[i] = static_cast<std::int8_t>(k.get(i));
+            cells[i] = mask_shift(home[i], pos[i] * stride(i));
+            cells_t[i] = mask_shift(home_t[i], pos[i] * stride_t(i));
+            occupied |= cells[i];
+            occupied_t |= cells_t[i];
+        }
+    }
+
+    // Bit distance between consecutive cells of car i in each mask.
+    int stride(int i) const { return horiz[i] ? 1 : dim(); }
+    int stride_t(int i) const { return horiz[i] ? dim() : 1; }
+
+    // Occupied cells of car i's lane, bit k = lane index k.
+    unsigned lane_bits(int i) const {
+        return mask_lane(horiz[i] ? occupied : occupied_t, lane[i] * dim(), dim());
+    }
+
+    // Number of free cells in front of (towards higher index) car i.
+    int room_after(int i) const {
+        int end = pos[i] + lengths[i];
+        unsigned ahead = (lane_bits(i) >> end) | (1u << (dim() - end));
+        return __builtin_ctz(ahead);
+    }
+
+    // Number of free cells behind (towards index 0) car i.
+    int room_before(int i) const {
+        unsigned behind = lane_bits(i) & ((1u << pos[i]) - 1);
+        if (!behind) return pos[i];
+        return pos[i] - 1 - (31 - __builtin_clz(behind));
+    }
+
+    // Slides car i by delta cells; the caller guarantees the range is free.
+    void move(int i, int delta) {
+        occupied &= ~cells[i];
+        occupied_t &= ~cells_t[i];
+        cells[i] = mask_shift(cells[i], delta * stride(i));
+        cells_t[i] = mask_shift(cells_t[i], delta * stride_t(i));
+        occupied |= cells[i];
+        occupied_t |= cells_t[i];
+        pos[i] = static_cast<std::int8_t>(pos[i] + delta);
+    }
+
+    StateKey key() const {
+        StateKey k;
+        for (int i = 0; i < nbCars; i++) k.set(i, pos[i]);
+        return k;
+    }
+
+    bool is_free(int row, int col) const {
+        return !mask_test(occupied, row * dim() + col);
+    }
+
+    // Calls visit(car, delta) for every legal slide of the current layout, cars
+    // in index order and deltas from farthest back to farthest forward. Meant
+    // to be inlined into search loops; nothing is allocated.
+    template <typename Visit>
+    void for_each_move(Visit&& visit) const {
+        for (int i = 0; i < nbCars; i++) {
+            int before = room_before(i);
+            int after = room_after(i);
+            for (int d = -before; d <= after; d++) {
+                if (d != 0) visit(i, d);
+            }
+        }
+    }
+
+    // Same slides with the key they lead to: visit(child, car, delta).
+    // `from` must be key() of the current layout.
+    template <typename Visit>
+    void for_each_child(const StateKey& from, Visit&& visit) const {
+        for_each_move([&](int i, int d) {
+            StateKey child = from;
+            child.set(i, pos[i] + d);
+            visit(child, i, d);
+        });
+    }
+
+    // Writes the slides to out (room for MAX_MOVES) and returns how many, for
+    // callers that change the board while going through them.
+    int collect_moves(Move* out) const {
+        int n = 0;
+        for_each_move([&](int i, int d) { out[n++] = {static_cast<std::int8_t>(i), static_cast<std::int8_t>(d)}; });
+        return n;
+    }
+
+    // The first car (the red one) has reached the right edge.
+    bool success() const {
+        return pos[0] + lengths[0] == dim();
+    }
+};
+
+using Bitboard = BasicBitboard<std::uint64_t>;
+using WideBitboard = BasicBitboard<WideMask>;
+
+// An NxN board holds at most N*N/2 cars of length 2 or more.
+template <int N>
+using FixedBitboard = BasicBitboard<std::uint64_t, N, (N * N / 2 < MAX_CARS ? N * N / 2 : MAX_CARS)>;
+
+// ======== Board type dispatch ======== //
+// Calls f(BoardType<B>()) with the board type suited to g and returns its
+// result: the 6x6, 7x7 and 8x8 specializations when g fits them, otherwise the
+// generic 64-bit board up to 8x8 and the wide one above. Solvers are written
+// as templates on the board and instantiated once per type here.
+template <typename Board>
+struct BoardType {
+    using type = Board;
+};
+
+template <typename F>
+auto with_board_type(const Game& g, F&& f) {
+    switch (g.size) {
+    case 6:
+        if (g.nbCars <= FixedBitboard<6>::max_cars) return f(BoardType<FixedBitboard<6>>());
+        break;
+    case 7:
+        if (g.nbCars <= FixedBitboard<7>::max_cars) return f(BoardType<FixedBitboard<7>>());
+        break;
+    case 8:
+        return f(BoardType<FixedBitboard<8>>());
+    }
+    if (g.size <= 8) return f(BoardType<Bitboard>());
+    return f(BoardType<WideBitboard>());
+}
+
+#endif
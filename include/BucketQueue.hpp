@@ -0,0 +1,83 @@
+#ifndef BUCKETQUEUE_HPP
+#define BUCKETQUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+// ======== Indexed bucket queue ======== //
+// Min-priority queue over node indices with small integer keys (A* f-values).
+// One bucket per key; each queued node remembers its slot in its bucket, so
+// decrease-key and removal are O(1) swaps. Within a bucket the most recently
+// pushed node comes out first, which favours deeper nodes on f-ties.
+class BucketQueue {
+public:
+    static constexpr std::uint32_t NOT_QUEUED = 0xFFFFFFFF;
+
+    // Empties the queue, keeping its memory.
+    void clear() {
+        for (auto& b : buckets) b.clear();
+        slot.clear();
+        keys.clear();
+        count = 0;
+        min_key = 0;
+    }
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    bool contains(std::uint32_t node) const {
+        return node < slot.size() && slot[node] != NOT_QUEUED;
+    }
+
+    void push(std::uint32_t node, int key) {
+        if (node >= slot.size()) {
+            slot.resize(node + 1, NOT_QUEUED);
+            keys.resize(node + 1, 0);
+        }
+        if (key >= static_cast<int>(buckets.size())) buckets.resize(key + 1);
+        slot[node] = static_cast<std::uint32_t>(buckets[key].size());
+        keys[node] = key;
+        buckets[key].push_back(node);
+        if (key < min_key) min_key = key;
+        count++;
+    }
+
+    // Moves a queued node to a smaller key, or queues it if it is not queued.
+    void decrease(std::uint32_t node, int key) {
+        if (contains(node)) remove(node);
+        push(node, key);
+    }
+
+    std::uint32_t pop() {
+        while (buckets[min_key].empty()) min_key++;
+        std::uint32_t node = buckets[min_key].back();
+        buckets[min_key].pop_back();
+        slot[node] = NOT_QUEUED;
+        count--;
+        return node;
+    }
+
+    int top_key() {
+        while (buckets[min_key].empty()) min_key++;
+        return min_key;
+    }
+
+private:
+    std::vector<std::vector<std::uint32_t>> buckets;
+    std::vector<std::uint32_t> slot;
+    std::vector<int> keys;
+    std::size_t count = 0;
+    int min_key = 0;
+
+    void remove(std::uint32_t node) {
+        std::vector<std::uint32_t>& b = buckets[keys[node]];
+        std::uint32_t last = b.back();
+        b[slot[node]] = last;
+        slot[last] = slot[node];
+        b.pop_back();
+        slot[node] = NOT_QUEUED;
+        count--;
+    }
+};
+
+#endif
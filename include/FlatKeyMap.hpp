@@ -0,0 +1,106 @@
+#ifndef FLATKEYMAP_HPP
+#define FLATKEYMAP_HPP
+
+#include "StateKey.hpp"
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+// ======== Open-addressing table of StateKeys ======== //
+// Linear probing over a power-of-two array. A control byte per slot is 0 when
+// empty and otherwise holds 7 bits of the hash, so most mismatches are rejected
+// without touching the 16-byte key. No erase: search tables only grow.
+template <typename Value>
+class FlatKeyMap {
+public:
+    explicit FlatKeyMap(size_t expected = 1024) { reserve(expected); }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return ctrl.size(); }
+    size_t memory_bytes() const { return ctrl.size() * (1 + sizeof(StateKey) + sizeof(Value)); }
+    double load_factor() const { return ctrl.empty() ? 0.0 : double(count) / ctrl.size(); }
+
+    void clear() {
+        std::fill(ctrl.begin(), ctrl.end(), 0);
+        count = 0;
+    }
+
+    void reserve(size_t expected) {
+        size_t cap = 16;
+        while (cap * 7 < expected * 10) cap <<= 1;
+        if (cap > ctrl.size()) rehash(cap);
+    }
+
+    Value* find(const StateKey& key) {
+        size_t h = StateKeyHash()(key);
+        std::uint8_t tag = tag_of(h);
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            if (ctrl[i] == 0) return nullptr;
+            if (ctrl[i] == tag && keys[i] == key) return &values[i];
+        }
+    }
+
+    const Value* find(const StateKey& key) const {
+        return const_cast<FlatKeyMap*>(this)->find(key);
+    }
+
+    bool contains(const StateKey& key) const { return find(key) != nullptr; }
+
+    // Returns the slot's value and whether the key was newly inserted.
+    std::pair<Value*, bool> insert(const StateKey& key, const Value& value = Value()) {
+        if ((count + 1) * 10 > ctrl.size() * 7) rehash(ctrl.size() * 2);
+        size_t h = StateKeyHash()(key);
+        std::uint8_t tag = tag_of(h);
+        size_t i = h & mask;
+        for (; ctrl[i] != 0; i = (i + 1) & mask) {
+            if (ctrl[i] == tag && keys[i] == key) return {&values[i], false};
+        }
+        ctrl[i] = tag;
+        keys[i] = key;
+        values[i] = value;
+        count++;
+        return {&values[i], true};
+    }
+
+    template <typename F>
+    void for_each(F&& f) const {
+        for (size_t i = 0; i < ctrl.size(); i++) {
+            if (ctrl[i]) f(keys[i], values[i]);
+        }
+    }
+
+private:
+    std::vector<std::uint8_t> ctrl;
+    std::vector<StateKey> keys;
+    std::vector<Value> values;
+    size_t mask = 0;
+    size_t count = 0;
+
+    static std::uint8_t tag_of(size_t h) {
+        return static_cast<std::uint8_t>(0x80 | (h >> 57));
+    }
+
+    void rehash(size_t cap) {
+        std::vector<std::uint8_t> old_ctrl(cap, 0);
+        std::vector<StateKey> old_keys(cap);
+        std::vector<Value> old_values(cap);
+        old_ctrl.swap(ctrl);
+        old_keys.swap(keys);
+        old_values.swap(values);
+        mask = cap - 1;
+        count = 0;
+        for (size_t j = 0; j < old_ctrl.size(); j++) {
+            if (old_ctrl[j]) insert(old_keys[j], old_values[j]);
+        }
+    }
+};
+
+struct NoValue {};
+
+class FlatKeySet : public FlatKeyMap<NoValue> {
+public:
+    using FlatKeyMap<NoValue>::FlatKeyMap;
+    bool insert(const StateKey& key) { return FlatKeyMap<NoValue>::insert(key).second; }
+};
+
+#endif
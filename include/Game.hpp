@@ -4,6 +4,14 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <bitset>
+#include "StateKey.hpp"
+
+constexpr int MAX_SIZE = 16;
+constexpr int MAX_CARS = 32;
+
+// Row-major occupancy (bit r * size + c) wide enough for any supported board.
+using WideMask = std::bitset<MAX_SIZE * MAX_SIZE>;
 
 
 template <typename T>
@@ -26,8 +34,9 @@ public:
     std::vector<std::vector<int>> positions; 
     std::vector<bool> horiz;            
     std::vector<int> lengths;           
-    std::vector<std::vector<bool>> free;     
+    WideMask occupied;
 
+    Game();
     Game(int n, int N, std::vector<std::vector<int>> pos,
          std::vector<bool> hori, std::vector<int> l);
     Game(std::string s);
@@ -39,6 +48,9 @@ public:
     };
 
     bool update_free();
+    bool is_free(int row, int col) const;
+    StateKey key() const;
+    void slide(int i, int delta);
 };
 
 #endif
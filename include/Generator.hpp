@@ -0,0 +1,81 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include "Game.hpp"
+#include "Search.hpp"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// ======== Puzzle generator ======== //
+// Boards of a chosen size, car count and difficulty (optimal number of
+// moves), the same for the same seed on every platform.
+//
+// Each attempt scatters the cars at random and keeps the layout if
+// Game::update_free() accepts it. The layouts reachable from there are then
+// enumerated with their distances to the exit (as StateSpace does), and the
+// farthest one within [min_moves, max_moves] becomes the board: random
+// layouts alone are mostly a handful of moves from the exit. Its difficulty is
+// checked by solving it with the BFS before it is returned, and a board
+// already returned by this generator is never returned again.
+//
+// An attempt whose layout reaches more than max_states layouts is dropped
+// unexplored, which bounds its time and memory; on large boards with few cars
+// most attempts are, and a larger max_states finds boards much faster.
+//
+// Attempt n draws from its own random stream, derived from the seed and n, so
+// attempts run on `jobs` threads at once and are then taken in order: the
+// boards depend on the seed only, not on the number of jobs.
+struct GeneratorOptions {
+    int size = 6;
+    int cars = 12;                    // including the red car
+    int min_moves = 10;               // target difficulty, inclusive
+    int max_moves = 40;
+    std::uint64_t seed = 1;
+    int max_attempts = 100000;        // random layouts tried per board
+    std::size_t max_states = 1 << 16; // layouts enumerated per attempt
+    int jobs = 1;                     // threads running attempts
+};
+
+// Why the options cannot produce a board, or empty if they can.
+std::string check_generator_options(const GeneratorOptions& options);
+
+class PuzzleGenerator {
+public:
+    explicit PuzzleGenerator(const GeneratorOptions& options);
+
+    // The next board and its optimal number of moves; false after
+    // max_attempts layouts without a new board in range.
+    bool next(Game& g, int& moves);
+
+    // Random layouts tried so far.
+    std::size_t attempts() const { return tried; }
+
+private:
+    // The outcome of one attempt: a few layouts at the same distance, the
+    // first of them checked with the BFS. Empty if none is in range.
+    struct Attempt {
+        std::vector<Game> candidates;
+        int moves = -1;
+    };
+
+    GeneratorOptions options;
+    std::size_t tried = 0;
+    std::uint64_t scheduled = 0;
+    std::deque<Attempt> ahead; // attempts run but not yet taken, in order
+    std::vector<std::unique_ptr<SearchWorkspace>> workspaces;
+    std::unordered_set<Game, Game::GameHash> returned;
+
+    Attempt attempt(std::uint64_t n, SearchWorkspace& workspace) const;
+    void run_ahead();
+};
+
+// `count` boards of the generator (all of them, or none on failure), with
+// their optimal numbers of moves in `moves` if given.
+bool generate_puzzles(const GeneratorOptions& options, std::size_t count, std::vector<Game>& games,
+                      std::vector<int>* moves = nullptr);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef HEURISTICS_HPP
+#define HEURISTICS_HPP
+
+#include <cstdint>
+#include <string>
+
+// ======== Admissible heuristics ======== //
+// Lower bounds on the number of moves left, where a move slides one car any
+// distance. All of them are 0 on solved boards.
+enum class Heuristic {
+    Trivial,           // 0
+    DistanceToExit,    // 1 while the red car is not at the exit
+    BlockingCars,      // 1 + cars standing between the red car and the exit
+    RecursiveBlocking  // BlockingCars + cars that must move to let blockers out
+};
+
+// Accepts the names used in main ("trivial", "blocking_cars", "distance_to_exit",
+// "recursive_blocking") and the older "blocking". False for anything else.
+bool parse_heuristic(const std::string& name, Heuristic& out);
+const char* heuristic_name(Heuristic h);
+
+// Bitmask of the cars (other than `skip`) overlapping rows [from, to) of column
+// `col`, the cells a vertical car must pass through.
+template <typename Board>
+std::uint32_t cars_in_column(const Board& b, int col, int from, int to, int skip) {
+    std::uint32_t found = 0;
+    for (int j = 0; j < b.nbCars; j++) {
+        if (j == skip) continue;
+        bool hit = b.horiz[j]
+            ? (b.lane[j] >= from && b.lane[j] < to && b.pos[j] <= col && col < b.pos[j] + b.lengths[j])
+            : (b.lane[j] == col && b.pos[j] < to && from < b.pos[j] + b.lengths[j]);
+        if (hit) found |= 1u << j;
+    }
+    return found;
+}
+
+template <typename Board>
+int heuristic_value(const Board& b, Heuristic h) {
+    if (h == Heuristic::Trivial || b.success()) return 0;
+    if (h == Heuristic::DistanceToExit) return 1;
+
+    int row = b.lane[0];
+    int end = b.pos[0] + b.lengths[0];
+    int blockers = 0;
+    std::uint32_t used = 0;
+    int extra = 0;
+    for (int i = 1; i < b.nbCars; i++) {
+        if (b.horiz[i] || b.lane[i] < end || b.pos[i] > row || b.pos[i] + b.lengths[i] <= row) continue;
+        blockers++;
+        if (h != Heuristic::RecursiveBlocking) continue;
+
+        // Cars in the way of each escape: up (last cell above the row) and
+        // down (first cell below it). A wall closes a direction entirely.
+        int len = b.lengths[i];
+        bool up_ok = row - len >= 0;
+        bool down_ok = row + 1 + len <= b.size;
+        std::uint32_t up = up_ok ? cars_in_column(b, b.lane[i], row - len, b.pos[i], i) : 0;
+        std::uint32_t down = down_ok ? cars_in_column(b, b.lane[i], b.pos[i] + len, row + 1 + len, i) : 0;
+        if ((up_ok && !up) || (down_ok && !down) || (!up_ok && !down_ok)) continue;
+
+        // This blocker needs some car from `need` to move first. Only count it
+        // when those cars are disjoint from the ones already counted, so every
+        // extra move is charged to a different car.
+        std::uint32_t need = (up_ok ? up : 0) | (down_ok ? down : 0);
+        if (need & used) continue;
+        used |= need;
+        extra++;
+    }
+    return 1 + blockers + extra;
+}
+
+#endif
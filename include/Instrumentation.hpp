@@ -0,0 +1,134 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ======== Search instrumentation ======== //
+// Counters filled by the solvers when the program is built with
+// -DUNBLOCKME_INSTRUMENT. In other builds SearchProbe is an empty class whose
+// calls inline to nothing, and the counters stay at zero.
+#ifdef UNBLOCKME_INSTRUMENT
+constexpr bool INSTRUMENTED = true;
+#else
+constexpr bool INSTRUMENTED = false;
+#endif
+
+struct SearchCounters {
+    std::size_t expanded = 0;
+    std::size_t generated = 0;         // children produced by the move generator
+    std::size_t duplicates = 0;        // children already in the visited table
+    std::vector<std::size_t> frontier; // states entering the frontier at each depth
+    double load_factor = 0;            // visited table at the end
+    double total_seconds = 0;
+    double movegen_seconds = 0;        // expansion time not spent in the two below
+    double hashing_seconds = 0;        // visited-table lookups and inserts
+    double queue_seconds = 0;          // arena and open-list operations
+
+    // Adds the counts and times of another thread (load_factor is kept).
+    void merge(const SearchCounters& other);
+    std::string to_json() const;
+};
+
+// During instrumented solves, a progress line goes to cerr at most every
+// `seconds` (0, the default, turns it off).
+void set_progress_interval(double seconds);
+double progress_interval();
+void print_progress(const SearchCounters& c);
+
+enum class Phase { Expand, Hashing, Queue };
+
+#ifdef UNBLOCKME_INSTRUMENT
+// One per thread. The phase clocks only run on one expansion in SAMPLE and
+// their totals are scaled up, which keeps clock reads out of most of the loop.
+class SearchProbe {
+public:
+    static constexpr std::size_t SAMPLE = 64;
+    using Clock = std::chrono::steady_clock;
+
+    class Timer {
+    public:
+        Timer(double* total, bool active) : total(active ? total : nullptr) {
+            if (total) start = Clock::now();
+        }
+        ~Timer() {
+            if (total) *total += std::chrono::duration<double>(Clock::now() - start).count() * SAMPLE;
+        }
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        double* total;
+        Clock::time_point start;
+    };
+
+    // reports: whether this probe prints the periodic progress lines.
+    explicit SearchProbe(bool reports = true)
+        : reports(reports && progress_interval() > 0), started(Clock::now()), last_report(started) {}
+
+    void expand() {
+        counters.expanded++;
+        sampling = counters.expanded % SAMPLE == 0;
+        if (reports && counters.expanded % 4096 == 0) report();
+    }
+
+    // A child at `depth` (moves from the start); fresh if it was not visited.
+    void child(int depth, bool fresh) {
+        counters.generated++;
+        if (!fresh) {
+            counters.duplicates++;
+            return;
+        }
+        if (static_cast<std::size_t>(depth) >= counters.frontier.size()) counters.frontier.resize(depth + 1, 0);
+        counters.frontier[depth]++;
+    }
+
+    Timer time(Phase phase) {
+        return Timer(phase == Phase::Expand ? &expand_seconds
+                     : phase == Phase::Hashing ? &counters.hashing_seconds
+                                               : &counters.queue_seconds,
+                     sampling);
+    }
+
+    // Fills out with this probe's counters; other threads' probes are merged
+    // into it by the caller.
+    void finish(double load_factor, SearchCounters& out) {
+        counters.load_factor = load_factor;
+        counters.total_seconds = std::chrono::duration<double>(Clock::now() - started).count();
+        double other = counters.hashing_seconds + counters.queue_seconds;
+        counters.movegen_seconds = expand_seconds > other ? expand_seconds - other : 0;
+        out = counters;
+    }
+
+private:
+    SearchCounters counters;
+    double expand_seconds = 0;
+    bool sampling = false;
+    bool reports;
+    Clock::time_point started, last_report;
+
+    void report() {
+        Clock::time_point now = Clock::now();
+        if (std::chrono::duration<double>(now - last_report).count() < progress_interval()) return;
+        last_report = now;
+        counters.total_seconds = std::chrono::duration<double>(now - started).count();
+        print_progress(counters);
+    }
+};
+#else
+class SearchProbe {
+public:
+    struct Timer {
+        ~Timer() {}
+    };
+    explicit SearchProbe(bool = true) {}
+    void expand() {}
+    void child(int, bool) {}
+    Timer time(Phase) { return Timer(); }
+    void finish(double, SearchCounters&) {}
+};
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef NODEARENA_HPP
+#define NODEARENA_HPP
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// ======== Node arena ======== //
+// Append-only store of search records addressed by 32-bit index. Memory comes
+// in chunks that double in size (BASE, 2 BASE, 4 BASE, ... records), so
+// growing never copies or moves what is already stored, as a vector does on
+// each doubling, and never needs the old and the new block at once. reset()
+// forgets the records in O(1) and keeps the chunks, so a solver that reuses
+// its arena allocates nothing once it has seen its largest search.
+template <typename T, int BaseBits = 10>
+class NodeArena {
+    static_assert(std::is_trivially_copyable<T>::value, "arena records must be trivially copyable");
+
+public:
+    static constexpr std::size_t BASE = std::size_t(1) << BaseBits;
+    static constexpr int MAX_CHUNKS = 33 - BaseBits; // enough for every 32-bit index
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    std::size_t capacity() const { return BASE * ((std::size_t(1) << allocated) - 1); }
+    std::size_t memory_bytes() const { return capacity() * sizeof(T); }
+
+    T& operator[](std::size_t i) {
+        std::size_t j = i + BASE;
+        int k = 63 - __builtin_clzll(j) - BaseBits;
+        return chunks[k][j - (BASE << k)];
+    }
+    const T& operator[](std::size_t i) const { return const_cast<NodeArena&>(*this)[i]; }
+
+    T& back() { return (*this)[count - 1]; }
+
+    void push_back(const T& value) {
+        if (count == capacity()) grow();
+        (*this)[count++] = value;
+    }
+
+    // Drops every record; the chunks stay for the next search.
+    void reset() { count = 0; }
+
+    // Makes room for n records without growing again.
+    void reserve(std::size_t n) {
+        while (capacity() < n) grow();
+    }
+
+private:
+    std::unique_ptr<T[]> chunks[MAX_CHUNKS];
+    int allocated = 0;
+    std::size_t count = 0;
+
+    void grow() {
+        chunks[allocated].reset(new T[BASE << allocated]);
+        allocated++;
+    }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef OPTIMALPATHS_HPP
+#define OPTIMALPATHS_HPP
+
+#include "Game.hpp"
+#include "Bitboard.hpp"
+#include "FlatKeyMap.hpp"
+#include "Search.hpp"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// ======== All optimal solutions ======== //
+// Every shortest move sequence of a board, counted and listed without storing
+// a path per layout. build() runs a BFS that records only each layout's depth,
+// level by level, up to the level of the first solved layout. Then it walks
+// that layered graph backwards from the solved layouts, keeping the layouts
+// one move closer to the start at each step. The result is the subgraph of
+// optimal paths, with the number of ways to the exit from each of its layouts.
+// Paths are produced on demand from that subgraph, so asking for the first k
+// costs k paths however many there are.
+class OptimalPaths {
+public:
+    // Searches g; false if g is not a valid board.
+    bool build(const Game& g, SearchStats* stats = nullptr);
+
+    bool solvable() const { return moves >= 0; }
+    // Moves of an optimal solution, -1 if there is none.
+    int length() const { return moves; }
+    // Number of distinct optimal move sequences; saturates at UINT64_MAX
+    // (see overflowed).
+    std::uint64_t count() const;
+    bool overflowed() const { return saturated; }
+    // Solved layouts reached by an optimal solution.
+    std::size_t goals() const { return nb_goals; }
+
+    // Calls visit(path) for the optimal solutions in a fixed order (by the
+    // car index of each move, then its slide) until visit returns false or
+    // `limit` paths were given. Returns how many were.
+    std::size_t enumerate(std::size_t limit, const std::function<bool(const std::vector<Move>&)>& visit) const;
+    // The first k paths of enumerate().
+    std::vector<std::vector<Move>> first(std::size_t k) const;
+
+private:
+    // A layout on an optimal path: its depth from the start and the number of
+    // optimal ways from it to the exit.
+    struct Entry {
+        std::uint64_t ways;
+        std::uint8_t depth;
+    };
+
+    Game game;
+    StateKey start;
+    int moves = -1;
+    std::size_t nb_goals = 0;
+    bool saturated = false;
+    FlatKeyMap<Entry> dag{0};
+
+    template <typename Board>
+    bool search(SearchStats* stats);
+    template <typename Board>
+    std::size_t walk(std::size_t limit, const std::function<bool(const std::vector<Move>&)>& visit) const;
+};
+
+#endif
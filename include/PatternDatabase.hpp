@@ -0,0 +1,92 @@
+#ifndef PATTERNDATABASE_HPP
+#define PATTERNDATABASE_HPP
+
+#include "Game.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ======== Pattern database ======== //
+// Exact distances to the exit in an abstraction of the board that keeps only
+// some of the cars: the red car and the other cars of its row, then the cars
+// crossing the row in front of it, then the cars in the columns of those
+// blockers, and so on while the table stays under the size limit. Dropping
+// cars can only make the puzzle easier, so every entry is an admissible bound
+// for the full board.
+//
+// The table is indexed by the pattern cars' coordinates in mixed radix and
+// holds one byte per abstract state (UNREACHABLE for overlapping layouts and
+// layouts that cannot reach the exit). Any board that has cars with the same
+// orientations, lanes and lengths as the pattern can use the database,
+// whatever its other cars.
+//
+// File format (native endianness):
+//   char magic[8] = "UBPDB01"; uint32 size; uint32 count;
+//   count x { uint8 horiz, uint8 lane, uint8 length, uint8 pad };
+//   uint64 entries; uint8 table[entries];
+class PatternDatabase {
+public:
+    static constexpr std::uint8_t UNREACHABLE = 0xFF;
+    static constexpr std::uint64_t DEFAULT_ENTRIES = std::uint64_t(1) << 20;
+
+    PatternDatabase() = default;
+    ~PatternDatabase();
+    PatternDatabase(const PatternDatabase&) = delete;
+    PatternDatabase& operator=(const PatternDatabase&) = delete;
+
+    // Retrograde BFS from every abstract goal layout of g's pattern, whose
+    // table holds at most max_entries (and at most 2^32 - 1) entries. Fails,
+    // with the reason in *error, if even the red car alone does not fit.
+    bool build(const Game& g, std::uint64_t max_entries = DEFAULT_ENTRIES, std::string* error = nullptr);
+    bool save(const std::string& path) const;
+    // Maps a file written by save(); the table is never copied.
+    bool open(const std::string& path);
+
+    // Points the lookup at the cars of g matching the pattern (in index order);
+    // false if g lacks one of them.
+    bool attach(const Game& g);
+    // True if build(g, max_entries) would choose this database's pattern, so
+    // that g can reuse it instead of building its own.
+    bool has_pattern_of(const Game& g, std::uint64_t max_entries = DEFAULT_ENTRIES) const;
+
+    bool empty() const { return table == nullptr; }
+    std::uint64_t entries() const { return nb_entries; }
+
+    template <typename Board>
+    int lookup(const Board& b) const {
+        std::uint64_t index = 0;
+        for (int k = 0; k < count; k++) index += b.pos[members[k]] * weight[k];
+        std::uint8_t d = table[index];
+        return d == UNREACHABLE ? 0 : d;
+    }
+
+private:
+    struct PatternCar {
+        std::uint8_t horiz, lane, length, pad;
+        bool operator==(const PatternCar& o) const {
+            return horiz == o.horiz && lane == o.lane && length == o.length;
+        }
+    };
+
+    int size = 0;
+    int count = 0;
+    std::vector<PatternCar> pattern;
+    int members[MAX_CARS];
+    std::uint64_t weight[MAX_CARS]; // mixed-radix place value of pattern car k
+    std::uint64_t nb_entries = 0;
+    const std::uint8_t* table = nullptr;
+    std::vector<std::uint8_t> owned;
+    void* mapping = nullptr;
+    std::size_t mapping_size = 0;
+
+    // Pattern cars of g: the red car first, then the others in index order;
+    // false if the red car alone needs more than max_entries.
+    static bool select(const Game& g, std::uint64_t max_entries, std::vector<int>& ids);
+    static PatternCar describe(const Game& g, int i);
+    void set_layout(int board_size, const std::vector<PatternCar>& cars);
+    template <typename Board>
+    void retrograde(const Game& abstract);
+    void release();
+};
+
+#endif
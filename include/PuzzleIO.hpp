@@ -0,0 +1,69 @@
+#ifndef PUZZLEIO_HPP
+#define PUZZLEIO_HPP
+
+#include "Game.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ======== Mapped files ======== //
+// Read-only mmap of a whole file; empty files map to an empty view.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    std::string_view view() const { return {static_cast<const char*>(data), length}; }
+
+private:
+    void* data = nullptr;
+    std::size_t length = 0;
+    void release();
+};
+
+// ======== Puzzle text ======== //
+// The data/ format: the board size, the number of cars, then one line per car
+// "index h|v length x y" (column and row of its first cell, from 1). Blank
+// lines and CR line ends are ignored. Numbers are read with std::from_chars
+// straight from the buffer, without copying lines.
+//
+// Fails with "line N: ..." in *error on a malformed line, a car count that
+// differs from the header, or a car that leaves the board or overlaps
+// another; `out` then holds the cars read so far.
+bool parse_puzzle(std::string_view text, Game& out, std::string* error = nullptr);
+// Maps the file and parses it.
+bool load_puzzle(const std::string& path, Game& out, std::string* error = nullptr);
+
+// ======== Puzzle packs ======== //
+// Many boards in one file, mapped once and decoded on demand.
+//
+// File format (native endianness):
+//   char magic[8] = "UBPACK1"; uint64 count; uint32 offsets[count + 1];
+//   then for each board, from data + offsets[i]:
+//     uint8 size, nbCars; nbCars x { uint8 horiz << 7 | length, uint8 (x - 1) << 4 | (y - 1) }
+// so boards are limited to 16x16 and MAX_CARS cars, like Game.
+class PuzzlePack {
+public:
+    bool open(const std::string& path);
+    std::size_t size() const { return count; }
+    // Decodes board i; false if it is out of range or damaged.
+    bool get(std::size_t i, Game& out) const;
+
+    static bool write(const std::string& path, const std::vector<Game>& games);
+    // The file starts with the pack magic.
+    static bool is_pack(const std::string& path);
+
+private:
+    MappedFile file;
+    std::size_t count = 0;
+    const std::uint32_t* offsets = nullptr;
+    const std::uint8_t* boards = nullptr;
+    std::size_t boards_size = 0;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include "Game.hpp"
+#include "StateKey.hpp"
+#include "Heuristics.hpp"
+#include "Instrumentation.hpp"
+#include "FlatKeyMap.hpp"
+#include "BucketQueue.hpp"
+#include "NodeArena.hpp"
+#include "PatternDatabase.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ======== Search nodes ======== //
+// Solvers keep one node per discovered state in a NodeArena. A node only
+// knows its parent's index and the move that produced it; the move list is
+// rebuilt once the goal is reached.
+constexpr std::uint32_t NO_PARENT = 0xFFFFFFFF;
+
+struct SearchNode {
+    StateKey key;
+    std::uint32_t parent;
+    std::int8_t car;
+    std::int8_t delta;
+};
+
+// g and h of an A* node, kept next to the arena.
+struct AStarInfo {
+    std::uint16_t g;
+    std::uint8_t h;
+};
+
+// ======== Reusable search memory ======== //
+// The arena and tables of the BFS and A* solvers. A long-running process keeps
+// one per worker thread and passes it to every solve, which clears it first but
+// keeps its capacity, so boards after the first reallocate nothing until they
+// outgrow the largest one seen.
+//
+// The "pattern_database" solvers also keep their databases here: pdb_file is
+// one mapped from a file (--pdb), empty if none, and pdb_built the ones built
+// for earlier boards, reused by every later board of the same pattern.
+struct SearchWorkspace {
+    static constexpr std::size_t MAX_BUILT_PDBS = 8;
+
+    NodeArena<SearchNode> nodes;
+    NodeArena<AStarInfo> info;
+    FlatKeySet visited{0};
+    FlatKeyMap<std::uint32_t> index{0};
+    BucketQueue open;
+    PatternDatabase pdb_file;
+    std::vector<std::unique_ptr<PatternDatabase>> pdb_built; // most recently used last
+};
+
+// The database attached to g for "pattern_database": pdb_file if g has its
+// cars, else the one built for g's pattern, built now if there is none (the
+// least recently used is dropped beyond MAX_BUILT_PDBS). nullptr if g cannot
+// have one.
+PatternDatabase* pattern_database_for(const Game& g, SearchWorkspace& workspace);
+
+// Work done by a solve: states expanded (their moves generated; a goal is not
+// expanded), states stored and the bytes held by the search's arena and tables
+// when it finished. IDA* stores a state each time it enters it in its
+// transposition table. counters is only filled by BFS (serial and parallel)
+// and A* in instrumented builds, and then counts the same expansions; its
+// `generated` counts every child, stored or not.
+struct SearchStats {
+    std::size_t expanded = 0;
+    std::size_t stored = 0;
+    std::size_t memory_bytes = 0;
+    SearchCounters counters;
+};
+
+// Moves from the root to nodes[goal], in the {car, delta} format of State::all_moves:
+// car index and signed number of cells, one move whatever the distance.
+std::vector<std::vector<int>> trace_moves(const NodeArena<SearchNode>& nodes, std::uint32_t goal);
+// Keys of the layouts from the root to nodes[goal], both included.
+std::vector<StateKey> trace_keys(const NodeArena<SearchNode>& nodes, std::uint32_t goal);
+
+// path_keys, if given, receives the layouts along the solution (see trace_keys).
+// Solvers taking a workspace use it instead of allocating their own.
+std::vector<std::vector<int>> bfs_shortest_path(const Game& g, SearchStats* stats = nullptr,
+                                                std::vector<StateKey>* path_keys = nullptr,
+                                                SearchWorkspace* workspace = nullptr);
+// Level-synchronous BFS over `threads` workers; same answer as bfs_shortest_path.
+std::vector<std::vector<int>> parallel_bfs_shortest_path(const Game& g, int threads, SearchStats* stats = nullptr);
+
+// A* with an admissible heuristic. Besides the names of Heuristics.hpp the
+// string form accepts "pattern_database" (see pattern_database_for); unknown
+// names fall back to "trivial".
+std::vector<std::vector<int>> astar_shortest_path(const Game& g, Heuristic heuristic, SearchStats* stats = nullptr,
+                                                  SearchWorkspace* workspace = nullptr);
+// A* guided by a pattern database, rebuilt in memory if it does not match g.
+std::vector<std::vector<int>> astar_shortest_path(const Game& g, PatternDatabase& pdb, SearchStats* stats = nullptr,
+                                                  SearchWorkspace* workspace = nullptr);
+std::vector<std::vector<int>> astar_shortest_path(const Game& g, const std::string& method,
+                                                  SearchStats* stats = nullptr,
+                                                  SearchWorkspace* workspace = nullptr);
+// Iterative-deepening A*: depth-first passes under a rising f bound, so memory
+// is linear in the solution length plus a transposition table of at most
+// max_memory bytes that cuts repeated layouts. Same heuristics and optimality
+// as astar_shortest_path; gives up (empty path) beyond 254 moves. The
+// workspace only serves "pattern_database".
+constexpr std::size_t IDA_DEFAULT_MEMORY = std::size_t(16) << 20;
+std::vector<std::vector<int>> ida_star_shortest_path(const Game& g, const std::string& method,
+                                                     std::size_t max_memory = IDA_DEFAULT_MEMORY,
+                                                     SearchStats* stats = nullptr,
+                                                     SearchWorkspace* workspace = nullptr);
+std::vector<std::vector<int>> ida_star_shortest_path(const Game& g, PatternDatabase& pdb,
+                                                     std::size_t max_memory = IDA_DEFAULT_MEMORY,
+                                                     SearchStats* stats = nullptr);
+// BFS for state spaces larger than RAM: each layer is a sorted, delta-compressed
+// file in a fresh directory under scratch_dir (removed afterwards), and
+// duplicates are dropped by merging against the two previous layers instead of
+// a visited table. max_memory bounds its buffers, the file ones included
+// (from about 300 kB on; below that they stay at their minimum).
+// Same answer as bfs_shortest_path; empty on unsolvable boards and I/O errors.
+std::vector<std::vector<int>> external_bfs_shortest_path(const Game& g, const std::string& scratch_dir,
+                                                         std::size_t max_memory = IDA_DEFAULT_MEMORY,
+                                                         SearchStats* stats = nullptr);
+// Meet-in-the-middle BFS between the start and every goal layout compatible
+// with it; falls back to bfs_shortest_path when there are too many goals.
+std::vector<std::vector<int>> bidirectional_shortest_path(const Game& g, SearchStats* stats = nullptr);
+
+// ======== Compact solutions ======== //
+// One move as shipped to clients: car index and its lane coordinate (0-based
+// first cell along its row or column, as in StateKey) before and after.
+struct CompactMove {
+    std::uint8_t car;
+    std::uint8_t from;
+    std::uint8_t to;
+};
+
+// Replays a {car, delta} move list from g's layout; stops at a malformed move.
+std::vector<CompactMove> compact_moves(const Game& g, const std::vector<std::vector<int>>& moves);
+
+// Solver by name: "bfs", "bidirectional", "external", "astar:<heuristic>" or
+// "idastar:<heuristic>" with any heuristic accepted by astar_shortest_path.
+// max_memory bounds the IDA* table and the RAM of "external", whose layers go
+// to the temporary directory ($TMPDIR or /tmp); the workspace serves "bfs",
+// "astar:*" and the pattern databases of "idastar:pattern_database".
+bool is_solver_name(const std::string& solver);
+std::vector<std::vector<int>> solve(const Game& g, const std::string& solver, SearchStats* stats = nullptr,
+                                    std::size_t max_memory = IDA_DEFAULT_MEMORY,
+                                    SearchWorkspace* workspace = nullptr);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SERVICE_HPP
+#define SERVICE_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+// ======== Service mode ======== //
+// A long-running solver fed with puzzles on a stream. Each request is a header
+// line "solve ID [SOLVER]" followed by the puzzle in the data/ file format
+// (size, number of cars, then that many car lines; blank lines are skipped).
+// ID is any word echoed back; SOLVER overrides the default solver for this
+// request. Requests are solved by `jobs` workers, each keeping its search
+// arena and tables from one request to the next, and one JSON line per request
+// is written as soon as it is solved, so answers come in completion order:
+//   {"id":"ID","solver":"bfs","status":"solved","moves":N,"solution":[[car,from,to],...],
+//    "expanded":...,"stored":...,"memory_bytes":...,"time_s":...}
+// status is "solved", "unsolvable" or "invalid" (then with an "error" field
+// instead of the rest). Each move of the solution slides car (1 = red,
+// numbered as in the puzzle) along its row or column from cell `from` to cell
+// `to`, counted from 0 at the left or top.
+struct ServiceOptions {
+    std::string solver = "bfs";
+    int jobs = 1;
+    std::size_t max_memory = 0; // bytes for each IDA* transposition table, 0 = default
+    std::string pdb_path;       // pattern database for "pattern_database", mapped by each worker
+};
+
+// Serves the requests read from `in` until end of input, then returns once
+// every answer is written to `out`. Returns the number of invalid requests.
+int run_service(const ServiceOptions& options, std::istream& in, std::ostream& out);
+
+// Listens on a Unix domain socket at `path` (replacing a stale socket file)
+// and serves any number of clients, each with the protocol above on its own
+// connection and all of them sharing the same workers. Only returns (with 1)
+// if the socket cannot be set up.
+int run_socket_service(const ServiceOptions& options, const std::string& path);
+
+#endif
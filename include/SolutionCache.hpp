@@ -0,0 +1,80 @@
+#ifndef SOLUTIONCACHE_HPP
+#define SOLUTIONCACHE_HPP
+
+#include "Game.hpp"
+#include "FlatKeyMap.hpp"
+#include "Search.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ======== Persistent solution cache ======== //
+// Distances to the exit of already solved layouts, kept in an append-only file
+// that is memory-mapped and survives restarts. Layouts are stored in canonical
+// form: the red car first, then the other cars sorted by orientation, length,
+// lane and position, so boards that only differ in the order of their car
+// lines (or by swapping cars of the same kind) share an entry.
+//
+// A solve records every layout of its optimal path with its remaining
+// distance; a later query on any of them rebuilds the rest of the path from
+// the cache alone by always stepping to a neighbour one move closer.
+//
+// File format (native endianness):
+//   char magic[8] = "UBSOL01"; uint64 count;
+//   then records of { uint8 size, nbCars, distance, pad; uint8 cars[2 * MAX_CARS] }
+//   where each car is (horiz << 7 | length, lane << 4 | pos).
+// Records are written before count is raised, so an interrupted append is
+// simply lost. One process at a time may write the file.
+class SolutionCache {
+public:
+    static constexpr std::uint8_t UNSOLVABLE = 0xFF;
+    static constexpr int UNKNOWN = -1;
+
+    SolutionCache() = default;
+    ~SolutionCache();
+    SolutionCache(const SolutionCache&) = delete;
+    SolutionCache& operator=(const SolutionCache&) = delete;
+
+    // Maps path, creating an empty cache file if there is none.
+    bool open(const std::string& path);
+    bool is_open() const { return mapping != nullptr; }
+    std::size_t size() const { return count; }
+
+    // Moves left from g's layout, UNSOLVABLE, or UNKNOWN if it is not cached.
+    int lookup(const Game& g) const;
+    // Records g's layout with its moves left (UNSOLVABLE: no solution) unless
+    // it is already there. Layouts UNSOLVABLE or more moves from the exit are
+    // not recorded, since their distance would read back as unsolvable.
+    bool insert(const Game& g, int distance);
+
+    // Cached path if g's layout is known; otherwise a BFS whose path is cached.
+    // stats are only filled when the BFS runs.
+    std::vector<std::vector<int>> shortest_path(const Game& g, SearchStats* stats = nullptr);
+
+private:
+    struct Record {
+        std::uint8_t size, nbCars, distance, pad;
+        std::uint8_t cars[2 * MAX_CARS];
+    };
+
+    int fd = -1;
+    void* mapping = nullptr;
+    std::size_t mapping_size = 0;
+    std::size_t count = 0;
+    FlatKeyMap<std::uint32_t> index; // fingerprint -> record
+
+    Record* records() const;
+    std::size_t capacity() const;
+    bool grow();
+    void release();
+
+    static StateKey fingerprint(const Record& r);
+    template <typename Board>
+    static Record canonical(const Board& b);
+    int find(const Record& r) const;
+    bool append(Record r, int distance);
+    template <typename Board>
+    std::vector<std::vector<int>> solve(const Game& g, SearchStats* stats);
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SOLVERSESSION_HPP
+#define SOLVERSESSION_HPP
+
+#include "Game.hpp"
+#include "Bitboard.hpp"
+#include "FlatKeyMap.hpp"
+#include "Search.hpp"
+#include <cstdint>
+
+// ======== Incremental solver session ======== //
+// Follows one puzzle while it is being played and answers "moves remaining"
+// and "best next move" for the current layout from distances it already
+// knows, searching only when the layout has none.
+//
+// The first search enumerates the layouts reachable from the board and labels
+// each with its exact distance to the exit, as StateSpace does. Moves never
+// leave that set, so every later query is a table lookup. When the set holds
+// more than max_states layouts, each search is a BFS instead, and only the
+// layouts along the solution it finds are labelled. Following the hints stays
+// on known ground; a move off the path costs one more BFS from there.
+//
+// Distances are kept in 16 bits. StateSpace's saturate at 254, so a set
+// whose farthest layout reaches that is not used either: its distances might
+// be short, and the BFS is exact at any length.
+class SolverSession {
+public:
+    static constexpr std::uint16_t UNSOLVABLE = 0xFFFF;
+    static constexpr std::size_t DEFAULT_MAX_STATES = std::size_t(1) << 20;
+
+    explicit SolverSession(std::size_t max_states = DEFAULT_MAX_STATES) : max_states(max_states) {}
+
+    // Starts a new puzzle, forgetting what was known; false if g is not a valid board.
+    bool start(const Game& g);
+    // Slides car i by delta cells on the current board; false (and no change)
+    // if the slide is not legal.
+    bool play(int car, int delta);
+
+    const Game& board() const { return current; }
+    // Moves left to the exit from the current layout with best play, -1 if the
+    // exit cannot be reached.
+    int moves_remaining();
+    // A slide that brings the current layout one move closer to the exit;
+    // false if it is solved or unsolvable.
+    bool best_move(Move& out);
+
+    // Layouts with a known distance, and the searches run so far.
+    std::size_t known() const { return distance.size(); }
+    std::size_t searches() const { return nb_searches; }
+    // Work of the last search.
+    const SearchStats& last_search() const { return stats; }
+
+private:
+    Game current;
+    std::size_t max_states;
+    std::size_t nb_searches = 0;
+    FlatKeyMap<std::uint16_t> distance{0};
+    SearchWorkspace workspace;
+    SearchStats stats;
+
+    int lookup();
+    void explore();
+};
+
+#endif
@@ -2,11 +2,15 @@
 #define STATE_HPP
 
 #include "Game.hpp"
+#include "Bitboard.hpp"
 #include <unordered_set>
 #include <queue>
 #include <string>
 #include <vector>
 
+class SolutionCache;
+struct SearchStats;
+
 class State {
 public:
     Game G; 
@@ -32,16 +36,34 @@ public:
     void showState();
     bool succeed();
 
+    // Calls visit(car, delta) for every legal slide of G; no allocation, and
+    // the visitor is inlined. next_States() is built on it.
+    template <typename Visit>
+    void for_each_move(Visit&& visit) const;
+    // Writes the slides of G to out (room for MAX_MOVES) and returns how many.
+    int collect_moves(Move* out) const;
+
     std::unordered_set<State, StateHash> next_States();
     std::unordered_set<State, StateHash> next_States_with_heuristic(std::string method);
 
     std::vector<std::vector<int>> shortest_path();
-    std::vector<std::vector<int>> shortest_path_with_heuristic(std::string method);
+    std::vector<std::vector<int>> shortest_path(int threads, SearchStats* stats = nullptr);
+    std::vector<std::vector<int>> shortest_path(SolutionCache& cache);
+    std::vector<std::vector<int>> shortest_path_with_heuristic(std::string method, SearchStats* stats = nullptr);
+    std::vector<std::vector<int>> shortest_path_ida(std::string method, std::size_t max_memory);
+    std::vector<std::vector<int>> shortest_path_bidirectional();
 
 private:
-    void states_in_direction(std::unordered_set<State, StateHash>& result, int i, bool right);
-    void states_in_direction_with_heuristic(std::unordered_set<State, StateHash>& result, int i, bool right, std::string method);
+    State child(int i, int delta) const;
 };
 
+template <typename Visit>
+void State::for_each_move(Visit&& visit) const {
+    with_board_type(G, [&](auto type) {
+        typename decltype(type)::type board;
+        if (board.load(G)) board.for_each_move(visit);
+    });
+}
+
 #endif
 
@@ -0,0 +1,46 @@
+#ifndef STATEKEY_HPP
+#define STATEKEY_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+// ======== Packed state key ======== //
+// One 4-bit coordinate per car along its own axis (car i uses bits 4i..4i+3),
+// which is enough for 32 cars on boards up to 16x16. Orientation, lengths and
+// lanes never change during a search, so they are left out.
+struct StateKey {
+    std::uint64_t lo = 0;
+    std::uint64_t hi = 0;
+
+    int get(int car) const {
+        const std::uint64_t& word = car < 16 ? lo : hi;
+        return static_cast<int>((word >> ((car & 15) * 4)) & 0xF);
+    }
+
+    void set(int car, int coord) {
+        std::uint64_t& word = car < 16 ? lo : hi;
+        int shift = (car & 15) * 4;
+        word = (word & ~(std::uint64_t(0xF) << shift)) | (std::uint64_t(coord) << shift);
+    }
+
+    bool operator==(const StateKey& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const StateKey& other) const { return !(*this == other); }
+};
+
+// splitmix64 finalizer: every input bit affects every output bit.
+inline std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+struct StateKeyHash {
+    size_t operator()(const StateKey& k) const {
+        return static_cast<size_t>(mix64(k.lo ^ mix64(k.hi + 0x9e3779b97f4a7c15ULL)));
+    }
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef STATESPACE_HPP
+#define STATESPACE_HPP
+
+#include "Game.hpp"
+#include "StateKey.hpp"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// ======== State-space enumeration ======== //
+// Every layout reachable from a board (its connected component: moves are
+// reversible) with its distance to the nearest solved layout, found by a BFS
+// from the board followed by a multi-source BFS from all of the solved
+// layouts. The key array is stored in discovery order and doubles as the queue
+// of both passes, so apart from the key index there is no separate frontier.
+struct StateSpace {
+    static constexpr std::uint8_t UNSOLVABLE = 0xFF;
+
+    std::vector<StateKey> keys;         // keys[0] is the starting layout
+    std::vector<std::uint8_t> distance; // moves to the exit, or UNSOLVABLE
+    std::size_t solved = 0;             // layouts with the red car at the exit
+    int max_distance = -1;              // -1 if no layout is solvable
+    std::size_t memory_bytes = 0;       // peak size of the keys, distances and index
+
+    // Number of layouts at each distance 0..max_distance.
+    std::vector<std::size_t> histogram() const;
+};
+
+// False if g is not a valid board or has more than max_states reachable layouts.
+bool enumerate_state_space(const Game& g, StateSpace& space,
+                           std::size_t max_states = std::numeric_limits<std::size_t>::max());
+
+// The first `limit` layouts (in discovery order) at space.max_distance.
+std::vector<Game> hardest_layouts(const Game& g, const StateSpace& space, std::size_t limit);
+
+// g with its cars moved to the coordinates stored in k.
+Game layout_from_key(const Game& g, const StateKey& k);
+// g in the puzzle file format read by Game(std::string).
+std::string board_text(const Game& g);
+
+#endif
@@ -0,0 +1,204 @@
+#include "Batch.hpp"
+#include "Game.hpp"
+#include "PuzzleIO.hpp"
+#include "Search.hpp"
+#include "State.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <glob.h>
+#include <sys/resource.h>
+
+// ======== Input expansion ======== //
+std::vector<std::string> expand_inputs(const std::vector<std::string>& inputs) {
+    std::vector<std::string> files;
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(input, ec)) {
+            std::vector<std::string> found;
+            for (const auto& entry : std::filesystem::directory_iterator(input, ec)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".txt") found.push_back(entry.path().string());
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else if (input.find_first_of("*?[") != std::string::npos) {
+            glob_t matches;
+            if (glob(input.c_str(), 0, nullptr, &matches) == 0) {
+                for (size_t i = 0; i < matches.gl_pathc; i++) files.push_back(matches.gl_pathv[i]);
+            } else {
+                std::cerr << "No file matches: " << input << "\n";
+            }
+            globfree(&matches);
+        } else {
+            files.push_back(input);
+        }
+    }
+    return files;
+}
+
+// ======== Result lines ======== //
+struct BatchResult {
+    std::string file;
+    std::string status; // "solved", "unsolvable", "unreadable" or "invalid"
+    int moves = -1;
+    SearchStats stats;
+    double seconds = 0;
+};
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+std::string json_escape(const std::string& s) {
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    for (char c : s) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (u < 0x20) {
+            out += "\\u00";
+            out += hex[u >> 4];
+            out += hex[u & 0xF];
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// s as one CSV field: in double quotes, with its own quotes doubled, so that
+// commas and line breaks stay inside it.
+static std::string csv_escape(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + '"';
+}
+
+static std::string format_result(const BatchResult& r, const BatchOptions& options) {
+    std::ostringstream line;
+    if (options.format == "csv") {
+        line << csv_escape(r.file) << ',' << csv_escape(options.solver) << ',' << r.status << ',' << r.moves
+             << ',' << r.stats.expanded << ',' << r.stats.stored << ',' << r.stats.memory_bytes << ',' << peak_rss_kb() << ',' << r.seconds;
+    } else {
+        line << "{\"file\":\"" << json_escape(r.file) << "\",\"solver\":\"" << json_escape(options.solver)
+             << "\",\"status\":\"" << r.status << "\",\"moves\":" << r.moves
+             << ",\"expanded\":" << r.stats.expanded << ",\"stored\":" << r.stats.stored
+             << ",\"memory_bytes\":" << r.stats.memory_bytes << ",\"peak_rss_kb\":" << peak_rss_kb()
+             << ",\"time_s\":" << r.seconds;
+        if (INSTRUMENTED) line << ",\"counters\":" << r.stats.counters.to_json();
+        line << '}';
+    }
+    return line.str();
+}
+
+static BatchResult solve_game(const std::string& name, const Game& g, const BatchOptions& options,
+                              SearchWorkspace& workspace) {
+    BatchResult r;
+    r.file = name;
+    auto start = std::chrono::steady_clock::now();
+    auto path_found = solve(g, options.solver, &r.stats,
+                            options.max_memory ? options.max_memory : IDA_DEFAULT_MEMORY, &workspace);
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    r.seconds = duration.count();
+    // An empty list is also what a board that starts solved returns.
+    State init_state(g);
+    if (path_found.empty() && !init_state.success()) {
+        r.status = "unsolvable";
+    } else {
+        r.status = "solved";
+        r.moves = static_cast<int>(path_found.size());
+    }
+    return r;
+}
+
+// One board to solve: a puzzle file, or entry `index` of a pack.
+struct BatchJob {
+    std::string name;
+    const PuzzlePack* pack = nullptr;
+    std::size_t index = 0;
+};
+
+static BatchResult run_job(const BatchJob& job, const BatchOptions& options, SearchWorkspace& workspace) {
+    BatchResult r;
+    r.file = job.name;
+    Game g;
+    if (job.pack) {
+        if (!job.pack->get(job.index, g)) {
+            r.status = "invalid";
+            return r;
+        }
+        return solve_game(job.name, g, options, workspace);
+    }
+    MappedFile file;
+    if (!file.open(job.name)) {
+        r.status = "unreadable";
+        return r;
+    }
+    std::string error;
+    if (!parse_puzzle(file.view(), g, &error)) {
+        std::cerr << job.name << ": " << error << "\n";
+        r.status = "invalid";
+        return r;
+    }
+    return solve_game(job.name, g, options, workspace);
+}
+
+// ======== Worker pool ======== //
+int run_batch(const BatchOptions& options, std::ostream& out) {
+    // Packs are mapped once and their boards queued one by one.
+    std::vector<std::unique_ptr<PuzzlePack>> packs;
+    std::vector<BatchJob> files;
+    for (const std::string& path : expand_inputs(options.inputs)) {
+        if (!PuzzlePack::is_pack(path)) {
+            files.push_back({path});
+            continue;
+        }
+        packs.push_back(std::make_unique<PuzzlePack>());
+        if (!packs.back()->open(path)) {
+            files.push_back({path});
+            continue;
+        }
+        for (std::size_t i = 0; i < packs.back()->size(); i++) {
+            files.push_back({path + "#" + std::to_string(i), packs.back().get(), i});
+        }
+    }
+    if (options.format == "csv") {
+        out << "file,solver,status,moves,expanded,stored,memory_bytes,peak_rss_kb,time_s\n";
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<int> failures(0);
+    std::mutex out_mutex;
+    // Each worker reuses one search arena and table set for all its boards.
+    auto worker = [&]() {
+        SearchWorkspace workspace;
+        if (!options.pdb_path.empty()) workspace.pdb_file.open(options.pdb_path);
+        for (size_t i; (i = next.fetch_add(1)) < files.size();) {
+            BatchResult r = run_job(files[i], options, workspace);
+            if (r.status != "solved") failures++;
+            std::string line = format_result(r, options);
+            std::lock_guard<std::mutex> lock(out_mutex);
+            out << line << '\n' << std::flush;
+        }
+    };
+
+    int jobs = std::max(1, std::min(options.jobs, static_cast<int>(files.size())));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < jobs; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+    return failures;
+}
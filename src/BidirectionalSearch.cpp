@@ -0,0 +1,131 @@
+#include "Search.hpp"
+#include "Bitboard.hpp"
+#include "FlatKeyMap.hpp"
+#include <algorithm>
+#include <limits>
+
+// Above this many goal layouts the backward side costs more than it saves.
+constexpr std::size_t MAX_GOALS = 1 << 18;
+
+// ======== Goal enumeration ======== //
+// Cars never leave their lane and two cars sharing a lane can never pass each
+// other, so a goal layout that breaks the start's order within a lane lies in
+// another component and is never generated.
+template <typename Board>
+static bool keeps_lane_order(const Board& start, int i, int p, const StateKey& key) {
+    for (int j = 0; j < i; j++) {
+        if (start.horiz[j] != start.horiz[i] || start.lane[j] != start.lane[i]) continue;
+        if ((start.pos[j] < start.pos[i]) != (key.get(j) < p)) return false;
+    }
+    return true;
+}
+
+// Places cars i.. in every non-overlapping way, the red car at the exit.
+// Returns false once MAX_GOALS is exceeded.
+template <typename Board>
+static bool place_cars(const Board& start, int i, StateKey& key,
+                       typename Board::mask_type occ, std::vector<StateKey>& goals) {
+    if (i == start.nbCars) {
+        if (goals.size() >= MAX_GOALS) return false;
+        goals.push_back(key);
+        return true;
+    }
+    int last = start.size - start.lengths[i];
+    for (int p = i == 0 ? last : 0; p <= last; p++) {
+        if (!keeps_lane_order(start, i, p, key)) continue;
+        auto cells = mask_shift(start.home[i], p * start.stride(i));
+        if (mask_any(occ & cells)) continue;
+        key.set(i, p);
+        if (!place_cars(start, i + 1, key, occ | cells, goals)) return false;
+    }
+    return true;
+}
+
+// ======== Bidirectional BFS ======== //
+// Each side is an arena searched level by level; the side with the smaller
+// frontier expands next. Every stored state is looked up on the other side,
+// and the best meeting found during the first level that produces one is
+// optimal: any shorter path would have met during an earlier level.
+struct SearchSide {
+    NodeArena<SearchNode> nodes;
+    NodeArena<std::uint16_t> depth;
+    FlatKeyMap<std::uint32_t> index;
+    std::uint32_t level_begin = 0;
+
+    void add(const SearchNode& n, int d) {
+        index.insert(n.key, static_cast<std::uint32_t>(nodes.size()));
+        nodes.push_back(n);
+        depth.push_back(static_cast<std::uint16_t>(d));
+    }
+    std::uint32_t frontier() const { return static_cast<std::uint32_t>(nodes.size()) - level_begin; }
+    std::size_t memory_bytes() const {
+        return nodes.memory_bytes() + depth.memory_bytes() + index.memory_bytes();
+    }
+};
+
+template <typename Board>
+static std::vector<std::vector<int>> bidirectional(const Game& g, SearchStats* stats) {
+    Board board;
+    if (!board.load(g)) return {};
+    if (board.success()) return {};
+
+    std::vector<StateKey> goals;
+    StateKey scratch;
+    if (!place_cars(board, 0, scratch, typename Board::mask_type{}, goals)) {
+        return bfs_shortest_path(g, stats);
+    }
+
+    SearchSide fwd, bwd;
+    fwd.add({board.key(), NO_PARENT, 0, 0}, 0);
+    for (const auto& k : goals) bwd.add({k, NO_PARENT, 0, 0}, 0);
+
+    std::size_t expanded = 0;
+    int best = std::numeric_limits<int>::max();
+    std::uint32_t meet_fwd = NO_PARENT, meet_bwd = NO_PARENT;
+
+    while (best == std::numeric_limits<int>::max() && fwd.frontier() && bwd.frontier()) {
+        bool forward = fwd.frontier() <= bwd.frontier();
+        SearchSide& side = forward ? fwd : bwd;
+        SearchSide& other = forward ? bwd : fwd;
+        std::uint32_t end = static_cast<std::uint32_t>(side.nodes.size());
+
+        for (std::uint32_t n = side.level_begin; n < end; n++, expanded++) {
+            StateKey key = side.nodes[n].key;
+            int d = side.depth[n] + 1;
+            board.load_key(key);
+            board.for_each_child(key, [&](const StateKey& child, int i, int delta) {
+                if (side.index.contains(child)) return;
+                side.add({child, n, static_cast<std::int8_t>(i), static_cast<std::int8_t>(delta)}, d);
+                const std::uint32_t* j = other.index.find(child);
+                if (j && d + other.depth[*j] < best) {
+                    best = d + other.depth[*j];
+                    std::uint32_t here = static_cast<std::uint32_t>(side.nodes.size() - 1);
+                    meet_fwd = forward ? here : *j;
+                    meet_bwd = forward ? *j : here;
+                }
+            });
+        }
+        side.level_begin = end;
+    }
+
+    if (stats) {
+        stats->expanded = expanded;
+        stats->stored = fwd.nodes.size() + bwd.nodes.size();
+        stats->memory_bytes = fwd.memory_bytes() + bwd.memory_bytes() + goals.capacity() * sizeof(StateKey);
+    }
+    if (meet_fwd == NO_PARENT) return {};
+
+    // Backward nodes record the move from their parent (nearer the goal), so
+    // walking towards the goal replays each move in reverse.
+    auto moves = trace_moves(fwd.nodes, meet_fwd);
+    for (std::uint32_t n = meet_bwd; bwd.nodes[n].parent != NO_PARENT; n = bwd.nodes[n].parent) {
+        moves.push_back({bwd.nodes[n].car, -bwd.nodes[n].delta});
+    }
+    return moves;
+}
+
+std::vector<std::vector<int>> bidirectional_shortest_path(const Game& g, SearchStats* stats) {
+    return with_board_type(g, [&](auto board) {
+        return bidirectional<typename decltype(board)::type>(g, stats);
+    });
+}
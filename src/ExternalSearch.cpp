@@ -0,0 +1,363 @@
+#include "Search.hpp"
+#include "Bitboard.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <queue>
+
+// Runs merged at once; more are first merged into larger runs.
+constexpr std::size_t MAX_FAN_IN = 64;
+// File buffer sizes, scaled with the memory budget between these bounds.
+constexpr std::size_t MIN_BUFFER = std::size_t(4) << 10;
+constexpr std::size_t MAX_LAYER_BUFFER = std::size_t(1) << 20;
+constexpr std::size_t MAX_RUN_BUFFER = std::size_t(1) << 16;
+
+// ======== Compressed key files ======== //
+// Sorted, duplicate-free keys stored as LEB128 varints of the difference to
+// the previous key (as 128-bit numbers). Keys of nearby layouts share their
+// high bits, so most take a few bytes instead of 16.
+using KeyValue = unsigned __int128;
+
+static KeyValue key_value(const StateKey& k) {
+    return (KeyValue(k.hi) << 64) | k.lo;
+}
+
+static StateKey key_from(KeyValue v) {
+    StateKey k;
+    k.lo = static_cast<std::uint64_t>(v);
+    k.hi = static_cast<std::uint64_t>(v >> 64);
+    return k;
+}
+
+class KeyWriter {
+public:
+    KeyWriter(const std::string& path, std::size_t buffer) : file(std::fopen(path.c_str(), "wb")), io(buffer) {
+        if (file) std::setvbuf(file, io.data(), _IOFBF, io.size());
+    }
+    ~KeyWriter() { close(); }
+
+    void put(const StateKey& k) {
+        if (!file) {
+            failed = true;
+            return;
+        }
+        KeyValue v = key_value(k);
+        KeyValue d = v - last;
+        last = v;
+        count++;
+        do {
+            int byte = static_cast<int>(d & 0x7F);
+            d >>= 7;
+            if (std::fputc(d ? byte | 0x80 : byte, file) == EOF) failed = true;
+        } while (d);
+    }
+
+    std::size_t size() const { return count; }
+
+    bool close() {
+        if (file && std::fclose(file) != 0) failed = true;
+        file = nullptr;
+        return !failed;
+    }
+
+private:
+    std::FILE* file;
+    std::vector<char> io;
+    KeyValue last = 0;
+    std::size_t count = 0;
+    bool failed = false;
+};
+
+class KeyReader {
+public:
+    KeyReader(const std::string& path, std::size_t buffer) : file(std::fopen(path.c_str(), "rb")), io(buffer) {
+        if (file) std::setvbuf(file, io.data(), _IOFBF, io.size());
+    }
+    ~KeyReader() {
+        if (file) std::fclose(file);
+    }
+
+    bool next(StateKey& k) {
+        if (!file) return false;
+        KeyValue d = 0;
+        int shift = 0;
+        for (int c; (c = std::fgetc(file)) != EOF; shift += 7) {
+            d |= KeyValue(c & 0x7F) << shift;
+            if (!(c & 0x80)) {
+                last += d;
+                k = key_from(last);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::FILE* file;
+    std::vector<char> io;
+    KeyValue last = 0;
+};
+
+// A reader one key ahead, for merging.
+struct KeyStream {
+    KeyReader reader;
+    StateKey head;
+    bool valid;
+
+    KeyStream(const std::string& path, std::size_t buffer) : reader(path, buffer) { valid = reader.next(head); }
+    void advance() { valid = reader.next(head); }
+};
+
+static bool key_less(const StateKey& a, const StateKey& b) {
+    return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo;
+}
+
+// ======== Runs ======== //
+// Calls out(key) for the union of the sorted runs, each key once.
+template <typename Out>
+static void merge_files(const std::vector<std::string>& runs, std::size_t buffer, Out&& out) {
+    std::vector<std::unique_ptr<KeyStream>> streams;
+    for (const auto& run : runs) streams.push_back(std::make_unique<KeyStream>(run, buffer));
+    auto later = [&](std::size_t a, std::size_t b) { return key_less(streams[b]->head, streams[a]->head); };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heap(later);
+    for (std::size_t i = 0; i < streams.size(); i++) {
+        if (streams[i]->valid) heap.push(i);
+    }
+    bool any = false;
+    StateKey last;
+    while (!heap.empty()) {
+        std::size_t i = heap.top();
+        heap.pop();
+        if (!any || streams[i]->head != last) {
+            last = streams[i]->head;
+            any = true;
+            out(last);
+        }
+        streams[i]->advance();
+        if (streams[i]->valid) heap.push(i);
+    }
+}
+
+// Sorted runs of the successors of one layer, spilled whenever the in-memory
+// buffer is full. Each run file is written and read through io_buffer bytes,
+// the merged ones through layer_buffer.
+class RunSet {
+public:
+    RunSet(const std::string& dir, std::size_t max_keys, std::size_t io_buffer, std::size_t layer_buffer)
+        : dir(dir), max_keys(max_keys), io_buffer(io_buffer), layer_buffer(layer_buffer) {
+        buffer.reserve(max_keys);
+    }
+
+    bool add(const StateKey& k) {
+        buffer.push_back(k);
+        return buffer.size() < max_keys || spill();
+    }
+
+    bool spill() {
+        if (buffer.empty()) return true;
+        std::sort(buffer.begin(), buffer.end(), key_less);
+        buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+        KeyWriter w(next_name(), io_buffer);
+        for (const auto& k : buffer) w.put(k);
+        buffer.clear();
+        return w.close();
+    }
+
+    // Merges the runs down to at most MAX_FAN_IN files and returns them.
+    bool finish(std::vector<std::string>& out) {
+        if (!spill()) return false;
+        while (runs.size() > MAX_FAN_IN) {
+            std::vector<std::string> group(runs.begin(), runs.begin() + MAX_FAN_IN);
+            runs.erase(runs.begin(), runs.begin() + MAX_FAN_IN);
+            std::string merged = dir + "/run-" + std::to_string(serial++);
+            KeyWriter w(merged, layer_buffer);
+            merge_files(group, io_buffer, [&](const StateKey& k) { w.put(k); });
+            if (!w.close()) return false;
+            for (const auto& run : group) std::remove(run.c_str());
+            runs.push_back(merged);
+        }
+        out.swap(runs);
+        runs.clear();
+        return true;
+    }
+
+    std::size_t memory_bytes() const { return buffer.capacity() * sizeof(StateKey); }
+    std::size_t run_buffer() const { return io_buffer; }
+
+private:
+    std::string dir;
+    std::size_t max_keys;
+    std::size_t io_buffer;
+    std::size_t layer_buffer;
+    std::vector<StateKey> buffer;
+    std::vector<std::string> runs;
+    std::size_t serial = 0;
+
+    std::string next_name() {
+        runs.push_back(dir + "/run-" + std::to_string(serial++));
+        return runs.back();
+    }
+};
+
+// ======== External-memory BFS ======== //
+// Layer d + 1 is built from layer d in three sequential passes: stream layer
+// d and spill its successors to sorted runs, merge the runs, and drop every
+// key also found in layers d - 1 and d while streaming those alongside. Moves
+// are reversible, so a successor of layer d can only lie in layers d - 1, d
+// or d + 1, and those two files are all the duplicate detection needs. RAM is
+// the run buffer plus the file buffers; everything else is on disk.
+//
+// At most four layer files and MAX_FAN_IN runs are open at once. A quarter of
+// max_memory goes to their buffers and the rest to the run buffer, so the
+// total stays within max_memory down to about 300 kB, where every buffer is
+// at its minimum.
+//
+// The layers are kept until the end to rebuild the path: from the goal, step
+// to any neighbour found in the previous layer, one sequential scan per move.
+class ExternalBFS {
+public:
+    ExternalBFS(const std::string& dir, std::size_t max_memory)
+        : dir(dir),
+          layer_buffer(std::clamp(max_memory / 32, MIN_BUFFER, MAX_LAYER_BUFFER)),
+          runs(dir, run_keys(max_memory), run_buffer(max_memory), layer_buffer) {}
+
+    template <typename Board>
+    bool run(Board& board, std::vector<std::vector<int>>& moves, SearchStats* stats) {
+        StateKey goal;
+        int depth = 0;
+        bool found = false;
+        {
+            KeyWriter w(layer(0), layer_buffer);
+            w.put(board.key());
+            if (!w.close()) return false;
+        }
+        generated = 1;
+        found = board.success();
+        if (found) goal = board.key();
+
+        while (!found) {
+            // Successors of layer `depth`, to sorted runs.
+            KeyReader in(layer(depth), layer_buffer);
+            StateKey key;
+            while (in.next(key)) {
+                expanded++;
+                board.load_key(key);
+                bool ok = true;
+                board.for_each_child(key, [&](const StateKey& child, int, int) { ok = runs.add(child) && ok; });
+                if (!ok) return false;
+            }
+            std::vector<std::string> files;
+            if (!runs.finish(files)) return false;
+
+            // Merge, minus the two previous layers.
+            KeyStream current(layer(depth), layer_buffer);
+            std::unique_ptr<KeyStream> previous;
+            if (depth > 0) previous = std::make_unique<KeyStream>(layer(depth - 1), layer_buffer);
+            KeyWriter out(layer(depth + 1), layer_buffer);
+            merge_files(files, runs.run_buffer(), [&](const StateKey& k) {
+                if (seen(current, k) || (previous && seen(*previous, k))) return;
+                out.put(k);
+                board.load_key(k);
+                if (!found && board.success()) {
+                    found = true;
+                    goal = k;
+                }
+            });
+            if (!out.close()) return false;
+            for (const auto& f : files) std::remove(f.c_str());
+            generated += out.size();
+            depth++;
+            if (out.size() == 0) break;
+        }
+
+        if (stats) {
+            stats->expanded = expanded;
+            stats->stored = generated;
+            stats->memory_bytes = runs.memory_bytes() + io_bytes();
+        }
+        if (!found) return true;
+        return trace(board, goal, depth, moves);
+    }
+
+private:
+    std::string dir;
+    std::size_t layer_buffer;
+    RunSet runs;
+    std::size_t expanded = 0;
+    std::size_t generated = 0;
+
+    static std::size_t run_buffer(std::size_t max_memory) {
+        return std::clamp(max_memory / (8 * MAX_FAN_IN), MIN_BUFFER, MAX_RUN_BUFFER);
+    }
+    // What is left of the budget after the file buffers, in keys.
+    static std::size_t run_keys(std::size_t max_memory) {
+        std::size_t io = 4 * std::clamp(max_memory / 32, MIN_BUFFER, MAX_LAYER_BUFFER) +
+                         MAX_FAN_IN * run_buffer(max_memory);
+        return std::max<std::size_t>(1024, max_memory > io ? (max_memory - io) / sizeof(StateKey) : 0);
+    }
+    std::size_t io_bytes() const { return 4 * layer_buffer + MAX_FAN_IN * runs.run_buffer(); }
+
+    std::string layer(int d) const { return dir + "/layer-" + std::to_string(d); }
+
+    // Advances a sorted stream up to k; true if k is in it.
+    static bool seen(KeyStream& s, const StateKey& k) {
+        while (s.valid && key_less(s.head, k)) s.advance();
+        return s.valid && s.head == k;
+    }
+
+    template <typename Board>
+    bool trace(Board& board, StateKey key, int depth, std::vector<std::vector<int>>& moves) {
+        for (int d = depth; d > 0; d--) {
+            struct Step {
+                StateKey key;
+                int car, delta;
+            };
+            std::vector<Step> around;
+            board.load_key(key);
+            board.for_each_child(key, [&](const StateKey& child, int i, int delta) { around.push_back({child, i, delta}); });
+            std::sort(around.begin(), around.end(), [](const Step& a, const Step& b) { return key_less(a.key, b.key); });
+            KeyStream prev(layer(d - 1), layer_buffer);
+            bool stepped = false;
+            for (const Step& s : around) {
+                if (!seen(prev, s.key)) continue;
+                moves.push_back({s.car, -s.delta});
+                key = s.key;
+                stepped = true;
+                break;
+            }
+            if (!stepped) return false;
+        }
+        std::reverse(moves.begin(), moves.end());
+        return true;
+    }
+};
+
+template <typename Board>
+static std::vector<std::vector<int>> external_bfs(const Game& g, const std::string& scratch_dir,
+                                                  std::size_t max_memory, SearchStats* stats) {
+    Board board;
+    if (!board.load(g)) return {};
+    std::string pattern = scratch_dir + "/unblockme-bfs-XXXXXX";
+    if (!mkdtemp(&pattern[0])) {
+        std::perror(("Error creating a scratch directory in " + scratch_dir).c_str());
+        return {};
+    }
+    std::vector<std::vector<int>> moves;
+    bool ok = ExternalBFS(pattern, max_memory).run(board, moves, stats);
+    std::error_code ec;
+    std::filesystem::remove_all(pattern, ec);
+    if (!ok) {
+        std::fprintf(stderr, "Error writing the BFS layers in %s\n", scratch_dir.c_str());
+        return {};
+    }
+    return moves;
+}
+
+std::vector<std::vector<int>> external_bfs_shortest_path(const Game& g, const std::string& scratch_dir,
+                                                         std::size_t max_memory, SearchStats* stats) {
+    return with_board_type(g, [&](auto board) {
+        return external_bfs<typename decltype(board)::type>(g, scratch_dir, max_memory, stats);
+    });
+}
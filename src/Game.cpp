@@ -1,4 +1,5 @@
 #include "Game.hpp"
+#include "PuzzleIO.hpp"
 #include <sstream>
 #include <iostream>
 
@@ -34,68 +35,73 @@ std::vector<std::string> Splitbynewline(const std::string& input) {
 }
 
 // ======== Game Implementation ======== //
+Game::Game() : nbCars(0), size(0) {}
+
 Game::Game(int n, int N, std::vector<std::vector<int>> pos,
            std::vector<bool> hori, std::vector<int> l)
-    : nbCars(n), size(N), positions(pos), horiz(hori), lengths(l),
-      free(N, std::vector<bool>(N, true)) {}
+    : nbCars(n), size(N), positions(pos), horiz(hori), lengths(l) {}
 
 bool Game::operator==(const Game& other) const {
     return nbCars == other.nbCars && size == other.size &&
            positions == other.positions && horiz == other.horiz &&
-           lengths == other.lengths && free == other.free;
+           lengths == other.lengths && occupied == other.occupied;
 }
 
+// Only the car coordinates vary between states of one puzzle, so the packed
+// key is all that needs hashing.
 size_t Game::GameHash::operator()(const Game& g) const {
-    size_t h1 = std::hash<int>()(g.nbCars);
-    size_t h2 = std::hash<int>()(g.size);
-    Vector2DHash<int> positionsHasher;
-    VectorHash<bool> horizHasher;
-    VectorHash<int> lengthsHasher;
-    Vector2DHash<bool> freeHasher;
-    size_t h3 = positionsHasher(g.positions);
-    size_t h4 = horizHasher(g.horiz);
-    size_t h5 = lengthsHasher(g.lengths);
-    size_t h6 = freeHasher(g.free);
-    return h1 ^ (h2 << 1) ^ (h3 << 2) ^ (h4 << 3) ^ (h5 << 4) ^ (h6 << 5);
+    return StateKeyHash()(g.key());
+}
+
+StateKey Game::key() const {
+    StateKey k;
+    for (int i = 0; i < nbCars; i++) {
+        k.set(i, horiz[i] ? positions[i][0] - 1 : positions[i][1] - 1);
+    }
+    return k;
 }
 
 bool Game::update_free() {
-    std::vector<std::vector<bool>> new_free(size, std::vector<bool>(size, true));
+    if (size < 1 || size > MAX_SIZE || nbCars > MAX_CARS ||
+        static_cast<int>(positions.size()) < nbCars) return false;
+    WideMask new_occupied;
     for (int i = 0; i < nbCars; i++) {
         int row = positions[i][1] - 1;
         int col = positions[i][0] - 1;
         if (row < 0 || row >= size || col < 0 || col >= size) return false;
-        if (horiz[i]) {
-            for (int j = col; j < col + lengths[i]; j++) {
-                if (j >= size || !new_free[row][j]) return false;
-                new_free[row][j] = false;
-            }
-        } else {
-            for (int j = row; j < row + lengths[i]; j++) {
-                if (j >= size || !new_free[j][col]) return false;
-                new_free[j][col] = false;
-            }
+        int end = (horiz[i] ? col : row) + lengths[i];
+        if (end > size) return false;
+        for (int j = horiz[i] ? col : row; j < end; j++) {
+            int bit = horiz[i] ? row * size + j : j * size + col;
+            if (new_occupied.test(bit)) return false;
+            new_occupied.set(bit);
         }
     }
-    free = new_free;
+    occupied = new_occupied;
     return true;
 }
 
-Game::Game(std::string s) {
-    auto lines = Splitbynewline(s);
-    size = std::stoi(lines[0]);
-    nbCars = std::stoi(lines[1]);
-    for (int i = 2; i < lines.size(); i++) {
-        if (lines[i].empty()) continue;
-        std::istringstream iss(lines[i]);
-        int index, length, row, col;
-        char orientation;
-        if (iss >> index >> orientation >> length >> row >> col) {
-            horiz.push_back(orientation == 'h');
-            lengths.push_back(length);
-            positions.push_back({row, col});
-        } else {
-            std::cerr << "Error: Invalid data in line: " << lines[i] << std::endl;
-        }
+bool Game::is_free(int row, int col) const {
+    return !occupied.test(row * size + col);
+}
+
+// Moves car i by delta cells along its axis, updating only the cells it leaves
+// and enters. The caller checks that the destination is free.
+void Game::slide(int i, int delta) {
+    int row = positions[i][1] - 1;
+    int col = positions[i][0] - 1;
+    int stride = horiz[i] ? 1 : size;
+    int first = row * size + col;
+    for (int k = 0; k < lengths[i]; k++) occupied.reset(first + k * stride);
+    first += delta * stride;
+    for (int k = 0; k < lengths[i]; k++) occupied.set(first + k * stride);
+    positions[i][horiz[i] ? 0 : 1] += delta;
+}
+
+// Parses the data/ text format; see parse_puzzle.
+Game::Game(std::string s) : nbCars(0), size(0) {
+    std::string error;
+    if (!parse_puzzle(s, *this, &error)) {
+        std::cerr << "Error: " << error << std::endl;
     }
 }
@@ -0,0 +1,161 @@
+#include "Generator.hpp"
+#include "StateSpace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+std::string check_generator_options(const GeneratorOptions& options) {
+    if (options.size < 3 || options.size > MAX_SIZE) return "size must be between 3 and " + std::to_string(MAX_SIZE);
+    int max_cars = std::min(MAX_CARS, options.size * options.size / 2);
+    if (options.cars < 1 || options.cars > max_cars) {
+        return "a " + std::to_string(options.size) + "x" + std::to_string(options.size) + " board holds 1 to " +
+               std::to_string(max_cars) + " cars";
+    }
+    if (options.min_moves < 1 || options.max_moves < options.min_moves || options.max_moves >= StateSpace::UNSOLVABLE) {
+        return "moves must satisfy 1 <= min <= max < " + std::to_string(StateSpace::UNSOLVABLE);
+    }
+    if (options.max_attempts < 1) return "at least one attempt is needed";
+    if (options.max_states < 1) return "max_states must be at least 1";
+    return "";
+}
+
+// ======== Random numbers ======== //
+// splitmix64, and a modulo rather than std::uniform_int_distribution, whose
+// output is left to the standard library: the boards of a seed must not
+// depend on the compiler. The modulo bias is below 2^-40 for these ranges.
+struct Random {
+    std::uint64_t state;
+
+    std::uint64_t next() {
+        state += 0x9e3779b97f4a7c15ULL;
+        return mix64(state);
+    }
+    std::size_t uniform(std::size_t n) { return static_cast<std::size_t>(next() % n); }
+};
+
+// ======== Attempts ======== //
+// The red car across the middle row, then the other cars wherever they fit:
+// a quarter of them of length 3, none lying in the red car's row, where they
+// would block the exit for good. False if a car found no room.
+static bool random_layout(const GeneratorOptions& options, Random& random, Game& g) {
+    const int n = options.size;
+    const int exit_row = (n + 1) / 2;
+    std::vector<bool> taken(n * n, false);
+    std::vector<std::vector<int>> positions;
+    std::vector<bool> horiz;
+    std::vector<int> lengths;
+
+    auto place = [&](bool h, int length, int col, int row) {
+        for (int k = 0; k < length; k++) {
+            if (taken[h ? (row - 1) * n + col - 1 + k : (row - 1 + k) * n + col - 1]) return false;
+        }
+        for (int k = 0; k < length; k++) taken[h ? (row - 1) * n + col - 1 + k : (row - 1 + k) * n + col - 1] = true;
+        positions.push_back({col, row});
+        horiz.push_back(h);
+        lengths.push_back(length);
+        return true;
+    };
+
+    place(true, 2, 1 + static_cast<int>(random.uniform(n - 2)), exit_row);
+    for (int car = 1; car < options.cars; car++) {
+        bool placed = false;
+        for (int tries = 0; tries < 64 && !placed; tries++) {
+            bool h = random.uniform(2) == 0;
+            int length = random.uniform(4) == 0 ? 3 : 2;
+            int lane = 1 + static_cast<int>(random.uniform(n));
+            if (h && lane == exit_row) continue;
+            int start = 1 + static_cast<int>(random.uniform(n - length + 1));
+            placed = h ? place(true, length, start, lane) : place(false, length, lane, start);
+        }
+        if (!placed) return false;
+    }
+    g = Game(options.cars, n, positions, horiz, lengths);
+    return g.update_free();
+}
+
+// Layouts kept per attempt, in case the first was already returned.
+constexpr std::size_t CANDIDATES = 4;
+
+PuzzleGenerator::Attempt PuzzleGenerator::attempt(std::uint64_t n, SearchWorkspace& workspace) const {
+    Attempt a;
+    Random random{mix64(options.seed + mix64(n))};
+    Game start;
+    StateSpace space;
+    if (!random_layout(options, random, start) || !enumerate_state_space(start, space, options.max_states)) return a;
+    int target = std::min(space.max_distance, options.max_moves);
+    if (target < options.min_moves) return a;
+
+    // The layouts at the target distance, from a random one on.
+    std::vector<std::size_t> at_target;
+    for (std::size_t k = 0; k < space.keys.size(); k++) {
+        if (space.distance[k] == target) at_target.push_back(k);
+    }
+    std::size_t first = random.uniform(at_target.size());
+    for (std::size_t c = 0; c < at_target.size() && c < CANDIDATES; c++) {
+        a.candidates.push_back(layout_from_key(start, space.keys[at_target[(first + c) % at_target.size()]]));
+    }
+    if (static_cast<int>(bfs_shortest_path(a.candidates[0], nullptr, nullptr, &workspace).size()) != target) {
+        a.candidates.clear();
+        return a;
+    }
+    a.moves = target;
+    return a;
+}
+
+// Runs the next few attempts, spread over the jobs, and queues them in order.
+void PuzzleGenerator::run_ahead() {
+    std::size_t count = workspaces.size() == 1 ? 1 : 8 * workspaces.size();
+    std::vector<Attempt> batch(count);
+    std::atomic<std::size_t> taken{0};
+    auto work = [&](SearchWorkspace& workspace) {
+        for (std::size_t k; (k = taken++) < count;) batch[k] = attempt(scheduled + k, workspace);
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < workspaces.size(); t++) threads.emplace_back(work, std::ref(*workspaces[t]));
+    work(*workspaces[0]);
+    for (auto& th : threads) th.join();
+    scheduled += count;
+    for (auto& a : batch) ahead.push_back(std::move(a));
+}
+
+PuzzleGenerator::PuzzleGenerator(const GeneratorOptions& options) : options(options) {
+    for (int t = 0; t < std::max(1, options.jobs); t++) workspaces.push_back(std::make_unique<SearchWorkspace>());
+}
+
+bool PuzzleGenerator::next(Game& g, int& moves) {
+    for (int k = 0; k < options.max_attempts; k++) {
+        if (ahead.empty()) run_ahead();
+        Attempt a = std::move(ahead.front());
+        ahead.pop_front();
+        tried++;
+        for (std::size_t c = 0; c < a.candidates.size(); c++) {
+            const Game& layout = a.candidates[c];
+            if (returned.count(layout)) continue;
+            // Only the first was solved by the attempt itself.
+            if (c > 0 && static_cast<int>(bfs_shortest_path(layout, nullptr, nullptr, workspaces[0].get()).size()) !=
+                             a.moves) break;
+            returned.insert(layout);
+            g = layout;
+            moves = a.moves;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool generate_puzzles(const GeneratorOptions& options, std::size_t count, std::vector<Game>& games,
+                      std::vector<int>* moves) {
+    PuzzleGenerator generator(options);
+    std::vector<Game> out;
+    std::vector<int> lengths;
+    for (std::size_t k = 0; k < count; k++) {
+        Game g;
+        int n = 0;
+        if (!generator.next(g, n)) return false;
+        out.push_back(g);
+        lengths.push_back(n);
+    }
+    games.swap(out);
+    if (moves) moves->swap(lengths);
+    return true;
+}
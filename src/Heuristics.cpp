@@ -0,0 +1,20 @@
+#include "Heuristics.hpp"
+
+bool parse_heuristic(const std::string& name, Heuristic& out) {
+    if (name == "trivial") out = Heuristic::Trivial;
+    else if (name == "distance_to_exit") out = Heuristic::DistanceToExit;
+    else if (name == "blocking_cars" || name == "blocking") out = Heuristic::BlockingCars;
+    else if (name == "recursive_blocking") out = Heuristic::RecursiveBlocking;
+    else return false;
+    return true;
+}
+
+const char* heuristic_name(Heuristic h) {
+    switch (h) {
+        case Heuristic::Trivial: return "trivial";
+        case Heuristic::DistanceToExit: return "distance_to_exit";
+        case Heuristic::BlockingCars: return "blocking_cars";
+        case Heuristic::RecursiveBlocking: return "recursive_blocking";
+    }
+    return "unknown";
+}
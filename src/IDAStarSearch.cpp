@@ -0,0 +1,170 @@
+#include "Search.hpp"
+#include "Bitboard.hpp"
+#include "PatternDatabase.hpp"
+#include <algorithm>
+#include <limits>
+
+// Longest solution looked for; A* stores g in 16 bits and h in 8, and no
+// known puzzle comes close.
+constexpr int IDA_MAX_DEPTH = 254;
+
+// ======== Transposition table ======== //
+// Direct-mapped and always-replace: a slot remembers the smallest depth at
+// which its layout was entered during the current iteration. Entering it again
+// no shallower cannot reach anything new (the first visit had at least as much
+// of the bound left), so that branch is cut. An overwritten slot only loses
+// pruning, never optimality.
+struct TranspositionEntry {
+    StateKey key;
+    std::uint16_t g;
+    std::uint16_t iteration; // 0: empty
+};
+
+class TranspositionTable {
+public:
+    // The largest power-of-two table within max_bytes (none below one entry).
+    explicit TranspositionTable(std::size_t max_bytes) {
+        std::size_t n = max_bytes / sizeof(TranspositionEntry);
+        std::size_t cap = 1;
+        while (cap * 2 <= n) cap <<= 1;
+        if (n) slots.assign(cap, TranspositionEntry{});
+    }
+
+    std::size_t memory_bytes() const { return slots.capacity() * sizeof(TranspositionEntry); }
+
+    // True if key was entered this iteration at depth <= g; records it otherwise.
+    bool seen(const StateKey& key, int g, int iteration) {
+        if (slots.empty()) return false;
+        TranspositionEntry& e = slots[StateKeyHash()(key) & (slots.size() - 1)];
+        if (e.iteration == iteration && e.key == key && e.g <= g) return true;
+        e = {key, static_cast<std::uint16_t>(g), static_cast<std::uint16_t>(iteration)};
+        return false;
+    }
+
+private:
+    std::vector<TranspositionEntry> slots;
+};
+
+// ======== Iterative-deepening A* ======== //
+// Depth-first passes bounded by f = g + h, the bound rising each pass to the
+// smallest f that was cut off. Only the current path is kept (one Move per
+// level, plus the slide buffer of each recursion frame), so apart from the
+// table memory is linear in the solution length. A car never moves twice in a
+// row: two slides of the same car are at best one slide.
+template <typename Board, typename Estimate>
+class IDAStar {
+public:
+    static constexpr int FOUND = -1;
+    static constexpr int NONE = std::numeric_limits<int>::max();
+
+    IDAStar(const Board& start, Estimate estimate, std::size_t max_memory)
+        : board(start), estimate(estimate), table(max_memory) {}
+
+    std::vector<std::vector<int>> run(SearchStats* stats) {
+        StateKey root = board.key();
+        int h0 = estimate(board);
+        bool solved = false;
+        path.reserve(64);
+        for (int bound = h0, iteration = 1; bound <= IDA_MAX_DEPTH; iteration++) {
+            limit = bound;
+            pass = iteration;
+            path.clear();
+            table.seen(root, 0, pass);
+            int t = search(root, 0, h0);
+            if (t == FOUND) {
+                solved = true;
+                break;
+            }
+            if (t == NONE) break;
+            bound = t;
+        }
+        if (stats) {
+            stats->expanded = expanded;
+            stats->stored = stored;
+            stats->memory_bytes = table.memory_bytes() + path.capacity() * sizeof(Move);
+            // No probe runs in the recursion; the counts are all it reports.
+            stats->counters.expanded = expanded;
+            stats->counters.generated = generated;
+        }
+        std::vector<std::vector<int>> moves;
+        if (!solved) return moves;
+        for (const Move& m : path) moves.push_back({m.car, m.delta});
+        return moves;
+    }
+
+private:
+    Board board;
+    Estimate estimate;
+    TranspositionTable table;
+    std::vector<Move> path;
+    int limit = 0;
+    int pass = 0;
+    std::size_t expanded = 0;
+    std::size_t generated = 0;
+    std::size_t stored = 0;
+
+    // FOUND (board and path left at the goal), NONE if nothing was cut off,
+    // or the smallest f above the bound.
+    int search(const StateKey& key, int g, int h) {
+        if (g + h > limit) return g + h;
+        if (board.success()) return FOUND;
+        expanded++;
+        Move moves[MAX_MOVES];
+        int nb_moves = board.collect_moves(moves);
+        int next = NONE;
+        for (int k = 0; k < nb_moves; k++) {
+            int i = moves[k].car;
+            int d = moves[k].delta;
+            if (!path.empty() && path.back().car == i) continue;
+            StateKey child = key;
+            child.set(i, board.pos[i] + d);
+            generated++;
+            if (table.seen(child, g + 1, pass)) continue;
+            stored++;
+            board.move(i, d);
+            path.push_back(moves[k]);
+            int t = search(child, g + 1, estimate(board));
+            if (t == FOUND) return FOUND;
+            path.pop_back();
+            board.move(i, -d);
+            next = std::min(next, t);
+        }
+        return next;
+    }
+};
+
+template <typename Board, typename Estimate>
+static std::vector<std::vector<int>> ida_star(const Game& g, Estimate estimate, std::size_t max_memory,
+                                              SearchStats* stats) {
+    Board board;
+    if (!board.load(g)) return {};
+    return IDAStar<Board, Estimate>(board, estimate, max_memory).run(stats);
+}
+
+std::vector<std::vector<int>> ida_star_shortest_path(const Game& g, PatternDatabase& pdb, std::size_t max_memory,
+                                                     SearchStats* stats) {
+    if (!pdb.attach(g) && !pdb.build(g)) return {};
+    auto estimate = [&pdb](const auto& board) {
+        return std::max(pdb.lookup(board), heuristic_value(board, Heuristic::RecursiveBlocking));
+    };
+    return with_board_type(g, [&](auto board) {
+        return ida_star<typename decltype(board)::type>(g, estimate, max_memory, stats);
+    });
+}
+
+std::vector<std::vector<int>> ida_star_shortest_path(const Game& g, const std::string& method,
+                                                     std::size_t max_memory, SearchStats* stats,
+                                                     SearchWorkspace* workspace) {
+    if (method == "pattern_database") {
+        SearchWorkspace local;
+        PatternDatabase* pdb = pattern_database_for(g, workspace ? *workspace : local);
+        if (!pdb) return {};
+        return ida_star_shortest_path(g, *pdb, max_memory, stats);
+    }
+    Heuristic heuristic = Heuristic::Trivial;
+    parse_heuristic(method, heuristic);
+    auto estimate = [heuristic](const auto& board) { return heuristic_value(board, heuristic); };
+    return with_board_type(g, [&](auto board) {
+        return ida_star<typename decltype(board)::type>(g, estimate, max_memory, stats);
+    });
+}
@@ -0,0 +1,41 @@
+#include "Instrumentation.hpp"
+#include <iostream>
+#include <sstream>
+
+static double progress_seconds = 0;
+
+void set_progress_interval(double seconds) {
+    progress_seconds = seconds > 0 ? seconds : 0;
+}
+
+double progress_interval() {
+    return progress_seconds;
+}
+
+void print_progress(const SearchCounters& c) {
+    std::cerr << "[progress] " << c.total_seconds << " s, expanded " << c.expanded << ", generated " << c.generated
+              << ", duplicates " << c.duplicates << ", depth " << (c.frontier.empty() ? 0 : c.frontier.size() - 1)
+              << std::endl;
+}
+
+void SearchCounters::merge(const SearchCounters& other) {
+    expanded += other.expanded;
+    generated += other.generated;
+    duplicates += other.duplicates;
+    if (other.frontier.size() > frontier.size()) frontier.resize(other.frontier.size(), 0);
+    for (std::size_t d = 0; d < other.frontier.size(); d++) frontier[d] += other.frontier[d];
+    movegen_seconds += other.movegen_seconds;
+    hashing_seconds += other.hashing_seconds;
+    queue_seconds += other.queue_seconds;
+}
+
+std::string SearchCounters::to_json() const {
+    std::ostringstream out;
+    out << "{\"expanded\":" << expanded << ",\"generated\":" << generated << ",\"duplicates\":" << duplicates
+        << ",\"frontier\":[";
+    for (std::size_t d = 0; d < frontier.size(); d++) out << (d ? "," : "") << frontier[d];
+    out << "],\"load_factor\":" << load_factor << ",\"total_s\":" << total_seconds
+        << ",\"movegen_s\":" << movegen_seconds << ",\"hashing_s\":" << hashing_seconds
+        << ",\"queue_s\":" << queue_seconds << "}";
+    return out.str();
+}
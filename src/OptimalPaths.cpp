@@ -0,0 +1,144 @@
+#include "OptimalPaths.hpp"
+#include <limits>
+
+// Depths are stored in a byte; like IDA*, longer solutions are not looked for.
+constexpr int MAX_DEPTH = 254;
+
+static std::uint64_t add_ways(std::uint64_t a, std::uint64_t b, bool& saturated) {
+    if (a > std::numeric_limits<std::uint64_t>::max() - b) {
+        saturated = true;
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+    return a + b;
+}
+
+// ======== Building the optimal subgraph ======== //
+template <typename Board>
+bool OptimalPaths::search(SearchStats* stats) {
+    Board board;
+    if (!board.load(game)) return false;
+    start = board.key();
+
+    // Forward: the depth of every layout, one level at a time, until a level
+    // holds a solved layout. `order` is in BFS order and doubles as the queue.
+    FlatKeyMap<std::uint8_t> depth;
+    NodeArena<StateKey> order;
+    std::vector<StateKey> layer;
+    depth.insert(start, 0);
+    order.push_back(start);
+    std::size_t level_begin = 0, expanded = 0;
+    int d = 0;
+    while (level_begin < order.size()) {
+        std::size_t level_end = order.size();
+        for (std::size_t n = level_begin; n < level_end; n++) {
+            board.load_key(order[n]);
+            if (board.success()) layer.push_back(order[n]);
+        }
+        if (!layer.empty() || d == MAX_DEPTH) break;
+        for (std::size_t n = level_begin; n < level_end; n++, expanded++) {
+            StateKey key = order[n];
+            board.load_key(key);
+            board.for_each_child(key, [&](const StateKey& child, int, int) {
+                if (depth.insert(child, static_cast<std::uint8_t>(d + 1)).second) order.push_back(child);
+            });
+        }
+        level_begin = level_end;
+        d++;
+    }
+    if (stats) {
+        stats->expanded = expanded;
+        stats->stored = order.size();
+        stats->memory_bytes = depth.memory_bytes() + order.memory_bytes();
+    }
+    if (layer.empty()) return true;
+    moves = d;
+    nb_goals = layer.size();
+
+    // Backward: from the solved layouts, keep the neighbours one level
+    // shallower; each inherits the ways to the exit of the layouts it leads to.
+    for (const StateKey& goal : layer) dag.insert(goal, {1, static_cast<std::uint8_t>(d)});
+    std::vector<StateKey> shallower;
+    for (int k = d; k > 0; k--) {
+        shallower.clear();
+        for (const StateKey& s : layer) {
+            std::uint64_t ways = dag.find(s)->ways;
+            board.load_key(s);
+            board.for_each_child(s, [&](const StateKey& p, int, int) {
+                const std::uint8_t* dp = depth.find(p);
+                if (!dp || *dp != k - 1) return;
+                auto res = dag.insert(p, {0, static_cast<std::uint8_t>(k - 1)});
+                if (res.second) shallower.push_back(p);
+                res.first->ways = add_ways(res.first->ways, ways, saturated);
+            });
+        }
+        layer.swap(shallower);
+    }
+    if (stats) stats->memory_bytes += dag.memory_bytes();
+    return true;
+}
+
+bool OptimalPaths::build(const Game& g, SearchStats* stats) {
+    game = g;
+    moves = -1;
+    nb_goals = 0;
+    saturated = false;
+    dag.clear();
+    return with_board_type(game, [&](auto board) {
+        return search<typename decltype(board)::type>(stats);
+    });
+}
+
+std::uint64_t OptimalPaths::count() const {
+    const Entry* e = solvable() ? dag.find(start) : nullptr;
+    return e ? e->ways : 0;
+}
+
+// ======== Listing paths ======== //
+// Depth-first from the start through the subgraph: every layout in it leads
+// to a solved one, so no branch is a dead end and each leaf is a new path.
+template <typename Board>
+std::size_t OptimalPaths::walk(std::size_t limit,
+                               const std::function<bool(const std::vector<Move>&)>& visit) const {
+    Board board;
+    if (!solvable() || limit == 0 || !board.load(game)) return 0;
+    std::vector<Move> path;
+    std::size_t given = 0;
+    bool stop = false;
+    auto step = [&](auto& self, const StateKey& key, int d) -> void {
+        if (d == moves) {
+            given++;
+            stop = !visit(path) || given == limit;
+            return;
+        }
+        board.load_key(key);
+        Move slides[MAX_MOVES];
+        int nb_slides = board.collect_moves(slides);
+        for (int k = 0; k < nb_slides && !stop; k++) {
+            StateKey child = key;
+            child.set(slides[k].car, key.get(slides[k].car) + slides[k].delta);
+            const Entry* e = dag.find(child);
+            if (!e || e->depth != d + 1) continue;
+            path.push_back(slides[k]);
+            self(self, child, d + 1);
+            path.pop_back();
+        }
+    };
+    step(step, start, 0);
+    return given;
+}
+
+std::size_t OptimalPaths::enumerate(std::size_t limit,
+                                    const std::function<bool(const std::vector<Move>&)>& visit) const {
+    return with_board_type(game, [&](auto board) {
+        return walk<typename decltype(board)::type>(limit, visit);
+    });
+}
+
+std::vector<std::vector<Move>> OptimalPaths::first(std::size_t k) const {
+    std::vector<std::vector<Move>> paths;
+    enumerate(k, [&](const std::vector<Move>& path) {
+        paths.push_back(path);
+        return true;
+    });
+    return paths;
+}
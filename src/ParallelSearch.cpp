@@ -0,0 +1,225 @@
+#include "Search.hpp"
+#include "Bitboard.hpp"
+#include "FlatKeyMap.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// ======== Sharded visited table ======== //
+// Each key maps to the rank of the move that discovered it, and a shard is
+// picked from the top hash bits so threads rarely contend on the same lock.
+// The rank orders moves exactly like the serial BFS visits them (parent index,
+// then car, then delta), so keeping the smallest rank per key reproduces the
+// serial parent choice whatever the thread interleaving.
+static std::uint64_t move_rank(std::uint32_t parent, int car, int delta) {
+    return (std::uint64_t(parent) << 16) | (std::uint64_t(car) << 8) | std::uint64_t(delta + 128);
+}
+
+class ShardedVisited {
+public:
+    static constexpr int SHARD_BITS = 6;
+
+    ShardedVisited() : shards(1 << SHARD_BITS) {}
+
+    // True if the key was not in the table before.
+    bool claim(const StateKey& key, std::uint64_t rank) {
+        Shard& s = shards[StateKeyHash()(key) >> (64 - SHARD_BITS)];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto res = s.map.insert(key, rank);
+        if (!res.second && rank < *res.first) *res.first = rank;
+        return res.second;
+    }
+
+    std::uint64_t rank(const StateKey& key) {
+        Shard& s = shards[StateKeyHash()(key) >> (64 - SHARD_BITS)];
+        return *s.map.find(key);
+    }
+
+    std::size_t memory_bytes() const {
+        std::size_t bytes = 0;
+        for (const Shard& s : shards) bytes += s.map.memory_bytes();
+        return bytes;
+    }
+
+    double load_factor() const {
+        std::size_t size = 0, capacity = 0;
+        for (const Shard& s : shards) {
+            size += s.map.size();
+            capacity += s.map.capacity();
+        }
+        return capacity ? double(size) / capacity : 0.0;
+    }
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        FlatKeyMap<std::uint64_t> map;
+    };
+    std::vector<Shard> shards;
+};
+
+// ======== Level barrier ======== //
+// Reusable barrier for a fixed number of threads (std::barrier is C++20):
+// wait() returns once all of them have called it, and then it starts over.
+class LevelBarrier {
+public:
+    explicit LevelBarrier(int count) : count(count) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::size_t round = generation;
+        if (++arrived == count) {
+            arrived = 0;
+            generation++;
+            all_arrived.notify_all();
+            return;
+        }
+        all_arrived.wait(lock, [&]() { return generation != round; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable all_arrived;
+    int count;
+    int arrived = 0;
+    std::size_t generation = 0;
+};
+
+// ======== Level-synchronous BFS ======== //
+// Every level of the arena is split into chunks handed out to the workers.
+// Workers write newly claimed keys into their own buffers; once the level is
+// done the buffers are merged and sorted by rank, which gives the next level
+// the exact order the serial BFS would have produced.
+//
+// Each worker counts into its own SearchProbe; they are merged at the end.
+template <typename Board>
+static std::vector<std::vector<int>> parallel_bfs(const Game& g, int threads, SearchStats* stats) {
+    Board start;
+    if (!start.load(g)) return {};
+    NodeArena<SearchNode> nodes;
+    ShardedVisited visited;
+    nodes.push_back({start.key(), NO_PARENT, 0, 0});
+    visited.claim(nodes[0].key, 0);
+
+    constexpr std::uint32_t CHUNK = 256;
+    std::vector<std::vector<StateKey>> buffers(threads);
+    std::vector<SearchProbe> probes;
+    for (int t = 0; t < threads; t++) probes.emplace_back(t == 0);
+    probes[0].child(0, true);
+    std::uint32_t lo = 0;
+    int depth = 0;
+
+    // Threads expand the whole of the last level, goals aside, so each counts
+    // its own expansions.
+    std::vector<std::size_t> expanded(threads, 0);
+    auto finish = [&]() {
+        if (!stats) return;
+        stats->expanded = 0;
+        for (std::size_t e : expanded) stats->expanded += e;
+        stats->stored = nodes.size();
+        stats->memory_bytes = nodes.memory_bytes() + visited.memory_bytes();
+        probes[0].finish(visited.load_factor(), stats->counters);
+        for (int t = 1; t < threads; t++) {
+            SearchCounters counters;
+            probes[t].finish(0, counters);
+            stats->counters.merge(counters);
+        }
+    };
+
+    // The workers are started once per solve. Each level, thread 0 publishes
+    // its bounds, everyone meets at the barrier, expands, and meets again
+    // before thread 0 merges the buffers; `done` at the first barrier ends them.
+    std::uint32_t hi = 0;
+    std::atomic<std::uint32_t> next(0);
+    std::atomic<std::uint32_t> goal(NO_PARENT);
+    bool done = false;
+    LevelBarrier barrier(threads);
+
+    auto expand_level = [&](int t, Board& board) {
+        SearchProbe& probe = probes[t];
+        std::vector<StateKey>& out = buffers[t];
+        out.clear();
+        std::size_t count = 0;
+        for (std::uint32_t begin; (begin = next.fetch_add(CHUNK)) < hi;) {
+            std::uint32_t end = std::min(hi, begin + CHUNK);
+            for (std::uint32_t n = begin; n < end; n++) {
+                StateKey key = nodes[n].key;
+                board.load_key(key);
+                if (board.success()) {
+                    std::uint32_t best = goal.load();
+                    while (n < best && !goal.compare_exchange_weak(best, n)) {}
+                    continue;
+                }
+                count++;
+                probe.expand();
+                auto expansion = probe.time(Phase::Expand);
+                board.for_each_child(key, [&](const StateKey& child, int i, int d) {
+                    bool fresh;
+                    {
+                        auto hashing = probe.time(Phase::Hashing);
+                        fresh = visited.claim(child, move_rank(n, i, d));
+                    }
+                    probe.child(depth + 1, fresh);
+                    if (!fresh) return;
+                    auto queue = probe.time(Phase::Queue);
+                    out.push_back(child);
+                });
+            }
+        }
+        expanded[t] += count;
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            Board board = start;
+            for (;;) {
+                barrier.wait();
+                if (done) return;
+                expand_level(t, board);
+                barrier.wait();
+            }
+        });
+    }
+
+    Board board = start;
+    while (lo < nodes.size()) {
+        hi = static_cast<std::uint32_t>(nodes.size());
+        next = lo;
+        barrier.wait();
+        expand_level(0, board);
+        barrier.wait();
+
+        if (goal != NO_PARENT) break;
+
+        std::vector<std::pair<std::uint64_t, StateKey>> level;
+        for (auto& out : buffers) {
+            for (const auto& key : out) level.push_back({visited.rank(key), key});
+        }
+        std::sort(level.begin(), level.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (const auto& e : level) {
+            nodes.push_back({e.second, static_cast<std::uint32_t>(e.first >> 16),
+                             static_cast<std::int8_t>((e.first >> 8) & 0xFF),
+                             static_cast<std::int8_t>(int(e.first & 0xFF) - 128)});
+        }
+        lo = hi;
+        depth++;
+    }
+    done = true;
+    barrier.wait();
+    for (auto& th : pool) th.join();
+
+    finish();
+    if (goal != NO_PARENT) return trace_moves(nodes, goal);
+    return {};
+}
+
+std::vector<std::vector<int>> parallel_bfs_shortest_path(const Game& g, int threads, SearchStats* stats) {
+    if (threads <= 1) return bfs_shortest_path(g, stats);
+    return with_board_type(g, [&](auto board) {
+        return parallel_bfs<typename decltype(board)::type>(g, threads, stats);
+    });
+}
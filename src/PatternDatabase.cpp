@@ -0,0 +1,258 @@
+#include "PatternDatabase.hpp"
+#include "Bitboard.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char PDB_MAGIC[8] = "UBPDB01";
+
+PatternDatabase::~PatternDatabase() {
+    release();
+}
+
+void PatternDatabase::release() {
+    if (mapping) munmap(mapping, mapping_size);
+    mapping = nullptr;
+    mapping_size = 0;
+    owned.clear();
+    table = nullptr;
+}
+
+// ======== Pattern selection ======== //
+// Cars are ranked by how directly they stand in the red car's way and added
+// rank by rank while the table fits in max_entries (a car that does not fit is
+// left out, whatever its rank):
+//   0: the red car and the other cars of its row
+//   1: vertical cars crossing the row in front of the red car
+//   2: cars with a cell in a column of a rank-1 car
+//   3: other vertical cars in front of the red car's back
+//   4: everything else
+bool PatternDatabase::select(const Game& g, std::uint64_t max_entries, std::vector<int>& ids) {
+    ids.clear();
+    if (static_cast<std::uint64_t>(g.size - g.lengths[0] + 1) > max_entries) return false;
+    int red_row = g.positions[0][1] - 1;
+    int red_col = g.positions[0][0] - 1;
+    int red_end = red_col + g.lengths[0];
+    auto col = [&](int i) { return g.positions[i][0] - 1; };
+    auto row = [&](int i) { return g.positions[i][1] - 1; };
+
+    std::vector<bool> blocker_col(g.size, false);
+    std::vector<int> rank(g.nbCars, 4);
+    for (int i = 0; i < g.nbCars; i++) {
+        if (i == 0 || (g.horiz[i] && row(i) == red_row)) rank[i] = 0;
+        else if (!g.horiz[i] && col(i) >= red_end && row(i) <= red_row && red_row < row(i) + g.lengths[i]) {
+            rank[i] = 1;
+            blocker_col[col(i)] = true;
+        }
+    }
+    for (int i = 0; i < g.nbCars; i++) {
+        if (rank[i] != 4) continue;
+        bool in_blocker_col = false;
+        if (g.horiz[i]) {
+            for (int c = col(i); c < col(i) + g.lengths[i]; c++) in_blocker_col = in_blocker_col || blocker_col[c];
+        } else {
+            in_blocker_col = blocker_col[col(i)];
+        }
+        if (in_blocker_col) rank[i] = 2;
+        else if (!g.horiz[i] && col(i) >= red_col) rank[i] = 3;
+    }
+
+    std::vector<bool> chosen(g.nbCars, false);
+    std::uint64_t entries = 1;
+    for (int r = 0; r <= 4; r++) {
+        for (int i = 0; i < g.nbCars; i++) {
+            std::uint64_t radix = g.size - g.lengths[i] + 1;
+            if (rank[i] != r || entries * radix > max_entries) continue;
+            chosen[i] = true;
+            entries *= radix;
+        }
+    }
+    for (int i = 0; i < g.nbCars; i++) {
+        if (chosen[i]) ids.push_back(i);
+    }
+    return true;
+}
+
+PatternDatabase::PatternCar PatternDatabase::describe(const Game& g, int i) {
+    int lane = g.horiz[i] ? g.positions[i][1] - 1 : g.positions[i][0] - 1;
+    return {static_cast<std::uint8_t>(g.horiz[i]), static_cast<std::uint8_t>(lane),
+            static_cast<std::uint8_t>(g.lengths[i]), 0};
+}
+
+void PatternDatabase::set_layout(int board_size, const std::vector<PatternCar>& cars) {
+    size = board_size;
+    count = static_cast<int>(cars.size());
+    pattern = cars;
+    nb_entries = 1;
+    for (int k = 0; k < count; k++) {
+        weight[k] = nb_entries;
+        nb_entries *= size - cars[k].length + 1;
+    }
+}
+
+bool PatternDatabase::attach(const Game& g) {
+    if (empty() || g.size != size || g.nbCars < 1 || !(describe(g, 0) == pattern[0])) return false;
+    members[0] = 0;
+    int next = 1;
+    for (int k = 1; k < count; k++, next++) {
+        while (next < g.nbCars && !(describe(g, next) == pattern[k])) next++;
+        if (next >= g.nbCars) return false;
+        members[k] = next;
+    }
+    return true;
+}
+
+bool PatternDatabase::has_pattern_of(const Game& g, std::uint64_t max_entries) const {
+    if (empty() || g.size != size || g.nbCars < 1) return false;
+    std::vector<int> ids;
+    if (!select(g, max_entries, ids) || static_cast<int>(ids.size()) != count) return false;
+    for (int k = 0; k < count; k++) {
+        if (!(describe(g, ids[k]) == pattern[k])) return false;
+    }
+    return true;
+}
+
+// ======== Retrograde BFS ======== //
+// Multi-source BFS from every layout of the pattern cars with the red car at
+// the exit. Moves are reversible, so the BFS depth of a layout is its
+// distance to the nearest goal.
+template <typename Board>
+void PatternDatabase::retrograde(const Game& abstract) {
+    Board board;
+    board.load(abstract);
+    owned.assign(nb_entries, UNREACHABLE);
+    std::vector<std::uint32_t> queue;
+
+    auto decode = [&](std::uint64_t index) {
+        StateKey key;
+        for (int k = 0; k < count; k++) key.set(k, static_cast<int>((index / weight[k]) % (size - pattern[k].length + 1)));
+        return key;
+    };
+
+    int radix0 = size - pattern[0].length + 1;
+    for (std::uint64_t rest = 0; rest < nb_entries / radix0; rest++) {
+        std::uint64_t index = (radix0 - 1) + rest * radix0;
+        StateKey key = decode(index);
+        typename Board::mask_type occ{};
+        bool overlap = false;
+        for (int k = 0; k < count && !overlap; k++) {
+            auto cells = mask_shift(board.home[k], key.get(k) * board.stride(k));
+            overlap = mask_any(occ & cells);
+            occ |= cells;
+        }
+        if (!overlap) {
+            owned[index] = 0;
+            queue.push_back(static_cast<std::uint32_t>(index));
+        }
+    }
+
+    for (std::size_t head = 0; head < queue.size(); head++) {
+        std::uint32_t index = queue[head];
+        int d = owned[index] + 1;
+        if (d >= UNREACHABLE) d = UNREACHABLE - 1;
+        board.load_key(decode(index));
+        board.for_each_move([&](int k, int delta) {
+            std::uint64_t child = index + delta * static_cast<std::int64_t>(weight[k]);
+            if (owned[child] != UNREACHABLE) return;
+            owned[child] = static_cast<std::uint8_t>(d);
+            queue.push_back(static_cast<std::uint32_t>(child));
+        });
+    }
+    table = owned.data();
+}
+
+bool PatternDatabase::build(const Game& g, std::uint64_t max_entries, std::string* error) {
+    auto fail = [&](const std::string& message) {
+        if (error) *error = message;
+        return false;
+    };
+    if (g.nbCars < 1 || g.size > MAX_SIZE) return fail("invalid board");
+    // The retrograde BFS queues entries by 32-bit index.
+    max_entries = std::min<std::uint64_t>(max_entries, std::numeric_limits<std::uint32_t>::max());
+    std::vector<int> ids;
+    std::vector<PatternCar> cars;
+    if (!select(g, max_entries, ids)) {
+        return fail("the red car alone needs " + std::to_string(g.size - g.lengths[0] + 1) +
+                    " entries, more than the limit of " + std::to_string(max_entries));
+    }
+    for (int i : ids) cars.push_back(describe(g, i));
+    release();
+    set_layout(g.size, cars);
+    if (nb_entries > max_entries) {
+        release();
+        return fail(std::to_string(nb_entries) + " entries exceed the limit of " + std::to_string(max_entries));
+    }
+    for (int k = 0; k < count; k++) members[k] = ids[k];
+
+    std::vector<std::vector<int>> positions;
+    std::vector<bool> horiz;
+    std::vector<int> lengths;
+    for (int i : ids) {
+        positions.push_back(g.positions[i]);
+        horiz.push_back(g.horiz[i]);
+        lengths.push_back(g.lengths[i]);
+    }
+    Game abstract(count, g.size, positions, horiz, lengths);
+    if (!abstract.update_free()) {
+        release();
+        return fail("the pattern cars overlap");
+    }
+    with_board_type(abstract, [&](auto board) { retrograde<typename decltype(board)::type>(abstract); });
+    return true;
+}
+
+// ======== Serialization ======== //
+bool PatternDatabase::save(const std::string& path) const {
+    if (empty()) return false;
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    std::uint32_t header[2] = {static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(count)};
+    out.write(PDB_MAGIC, sizeof(PDB_MAGIC));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(pattern.data()), count * sizeof(PatternCar));
+    out.write(reinterpret_cast<const char*>(&nb_entries), sizeof(nb_entries));
+    out.write(reinterpret_cast<const char*>(table), nb_entries);
+    return static_cast<bool>(out);
+}
+
+bool PatternDatabase::open(const std::string& path) {
+    release();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 24) {
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    mapping = data;
+    mapping_size = st.st_size;
+
+    const char* bytes = static_cast<const char*>(data);
+    std::uint32_t header[2];
+    std::memcpy(header, bytes + 8, sizeof(header));
+    std::size_t offset = 16 + header[1] * sizeof(PatternCar);
+    if (std::memcmp(bytes, PDB_MAGIC, sizeof(PDB_MAGIC)) != 0 || header[0] > MAX_SIZE ||
+        header[1] < 1 || header[1] > MAX_CARS || offset + 8 > mapping_size) {
+        release();
+        return false;
+    }
+    std::vector<PatternCar> cars(header[1]);
+    std::memcpy(cars.data(), bytes + 16, header[1] * sizeof(PatternCar));
+    set_layout(header[0], cars);
+    std::uint64_t stored;
+    std::memcpy(&stored, bytes + offset, sizeof(stored));
+    if (stored != nb_entries || offset + 8 + nb_entries > mapping_size) {
+        release();
+        return false;
+    }
+    table = reinterpret_cast<const std::uint8_t*>(bytes + offset + 8);
+    return true;
+}
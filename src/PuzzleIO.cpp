@@ -0,0 +1,231 @@
+#include "PuzzleIO.hpp"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char PACK_MAGIC[8] = "UBPACK1";
+
+// ======== Mapped files ======== //
+MappedFile::~MappedFile() {
+    release();
+}
+
+void MappedFile::release() {
+    if (data) munmap(data, length);
+    data = nullptr;
+    length = 0;
+}
+
+bool MappedFile::open(const std::string& path) {
+    release();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size > 0) {
+        void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        data = mapped;
+        length = st.st_size;
+    }
+    ::close(fd);
+    return true;
+}
+
+// ======== Puzzle text ======== //
+// Reads the space-separated fields of one line.
+class LineReader {
+public:
+    explicit LineReader(std::string_view line) : p(line.data()), end(line.data() + line.size()) {}
+
+    bool number(int& value) {
+        skip_spaces();
+        auto res = std::from_chars(p, end, value);
+        if (res.ec != std::errc() || (res.ptr != end && !is_space(*res.ptr))) return false;
+        p = res.ptr;
+        return true;
+    }
+
+    bool letter(char& value) {
+        skip_spaces();
+        if (p == end || (p + 1 != end && !is_space(p[1]))) return false;
+        value = *p++;
+        return true;
+    }
+
+    bool done() {
+        skip_spaces();
+        return p == end;
+    }
+
+private:
+    const char* p;
+    const char* end;
+    static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+    void skip_spaces() {
+        while (p != end && is_space(*p)) p++;
+    }
+};
+
+static bool fail(std::string* error, int line, const std::string& message) {
+    if (error) *error = "line " + std::to_string(line) + ": " + message;
+    return false;
+}
+
+bool parse_puzzle(std::string_view text, Game& out, std::string* error) {
+    out.nbCars = 0;
+    out.size = 0;
+    out.positions.clear();
+    out.horiz.clear();
+    out.lengths.clear();
+    out.occupied.reset();
+
+    int header[2];
+    int headers = 0;
+    int number = 0;
+    WideMask occupied;
+    while (!text.empty()) {
+        std::size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text = eol == std::string_view::npos ? std::string_view() : text.substr(eol + 1);
+        number++;
+        LineReader reader(line);
+        if (reader.done()) continue;
+
+        if (headers < 2) {
+            if (!reader.number(header[headers]) || !reader.done()) {
+                return fail(error, number, headers == 0 ? "expected the board size" : "expected the number of cars");
+            }
+            headers++;
+            if (headers == 1 && (header[0] < 1 || header[0] > MAX_SIZE)) {
+                return fail(error, number, "board size must be 1 to " + std::to_string(MAX_SIZE));
+            }
+            if (headers == 2) {
+                if (header[1] < 1 || header[1] > MAX_CARS) {
+                    return fail(error, number, "number of cars must be 1 to " + std::to_string(MAX_CARS));
+                }
+                out.size = header[0];
+                out.nbCars = header[1];
+            }
+            continue;
+        }
+
+        int index, length, x, y;
+        char orientation;
+        if (!reader.number(index) || !reader.letter(orientation) || !reader.number(length) ||
+            !reader.number(x) || !reader.number(y) || !reader.done() ||
+            (orientation != 'h' && orientation != 'v')) {
+            return fail(error, number, "expected \"index h|v length x y\"");
+        }
+        if (static_cast<int>(out.positions.size()) == out.nbCars) {
+            return fail(error, number, "more cars than the " + std::to_string(out.nbCars) + " announced");
+        }
+        bool horiz = orientation == 'h';
+        int size = out.size;
+        if (length < 1 || x < 1 || y < 1 || (horiz ? x - 1 + length : x) > size ||
+            (horiz ? y : y - 1 + length) > size) {
+            return fail(error, number, "car outside the board");
+        }
+        for (int k = 0; k < length; k++) {
+            int bit = horiz ? (y - 1) * size + x - 1 + k : (y - 1 + k) * size + x - 1;
+            if (occupied.test(bit)) return fail(error, number, "car overlaps another car");
+            occupied.set(bit);
+        }
+        out.horiz.push_back(horiz);
+        out.lengths.push_back(length);
+        out.positions.push_back({x, y});
+    }
+    if (headers < 2) return fail(error, number, "missing board size or number of cars");
+    if (static_cast<int>(out.positions.size()) != out.nbCars) {
+        return fail(error, number, std::to_string(out.positions.size()) + " cars for the " +
+                                       std::to_string(out.nbCars) + " announced");
+    }
+    out.occupied = occupied;
+    return true;
+}
+
+bool load_puzzle(const std::string& path, Game& out, std::string* error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    return parse_puzzle(file.view(), out, error);
+}
+
+// ======== Puzzle packs ======== //
+bool PuzzlePack::is_pack(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[8] = {};
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0;
+}
+
+bool PuzzlePack::open(const std::string& path) {
+    count = 0;
+    if (!file.open(path)) return false;
+    std::string_view bytes = file.view();
+    std::uint64_t stored;
+    if (bytes.size() < 16 || std::memcmp(bytes.data(), PACK_MAGIC, sizeof(PACK_MAGIC)) != 0) return false;
+    std::memcpy(&stored, bytes.data() + 8, sizeof(stored));
+    std::size_t header = 16 + (stored + 1) * sizeof(std::uint32_t);
+    if (stored > bytes.size() || header > bytes.size()) return false;
+    offsets = reinterpret_cast<const std::uint32_t*>(bytes.data() + 16);
+    boards = reinterpret_cast<const std::uint8_t*>(bytes.data() + header);
+    boards_size = bytes.size() - header;
+    if (offsets[stored] > boards_size) return false;
+    count = stored;
+    return true;
+}
+
+bool PuzzlePack::get(std::size_t i, Game& out) const {
+    if (i >= count || offsets[i] + 2 > offsets[i + 1] || offsets[i + 1] > boards_size) return false;
+    const std::uint8_t* p = boards + offsets[i];
+    int size = p[0], cars = p[1];
+    if (offsets[i] + 2 + 2 * cars != offsets[i + 1] || cars < 1 || cars > MAX_CARS) return false;
+    out.size = size;
+    out.nbCars = cars;
+    out.positions.clear();
+    out.horiz.clear();
+    out.lengths.clear();
+    for (int k = 0; k < cars; k++) {
+        std::uint8_t shape = p[2 + 2 * k], cell = p[3 + 2 * k];
+        out.horiz.push_back(shape >> 7);
+        out.lengths.push_back(shape & 0x7F);
+        out.positions.push_back({(cell >> 4) + 1, (cell & 0xF) + 1});
+    }
+    return out.update_free();
+}
+
+bool PuzzlePack::write(const std::string& path, const std::vector<Game>& games) {
+    std::vector<std::uint32_t> offsets{0};
+    std::vector<std::uint8_t> boards;
+    for (const Game& g : games) {
+        if (g.size < 1 || g.size > MAX_SIZE || g.nbCars < 1 || g.nbCars > MAX_CARS ||
+            static_cast<int>(g.positions.size()) < g.nbCars) return false;
+        boards.push_back(static_cast<std::uint8_t>(g.size));
+        boards.push_back(static_cast<std::uint8_t>(g.nbCars));
+        for (int k = 0; k < g.nbCars; k++) {
+            boards.push_back(static_cast<std::uint8_t>((g.horiz[k] << 7) | g.lengths[k]));
+            boards.push_back(static_cast<std::uint8_t>(((g.positions[k][0] - 1) << 4) | (g.positions[k][1] - 1)));
+        }
+        offsets.push_back(static_cast<std::uint32_t>(boards.size()));
+    }
+    std::ofstream out(path, std::ios::binary);
+    std::uint64_t stored = games.size();
+    out.write(PACK_MAGIC, sizeof(PACK_MAGIC));
+    out.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(std::uint32_t));
+    out.write(reinterpret_cast<const char*>(boards.data()), boards.size());
+    return static_cast<bool>(out);
+}
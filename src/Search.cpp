@@ -0,0 +1,273 @@
+#include "Search.hpp"
+#include "Bitboard.hpp"
+#include "PatternDatabase.hpp"
+#include <algorithm>
+#include <filesystem>
+
+// ======== Path reconstruction ======== //
+std::vector<std::vector<int>> trace_moves(const NodeArena<SearchNode>& nodes, std::uint32_t goal) {
+    std::vector<std::vector<int>> moves;
+    for (std::uint32_t n = goal; nodes[n].parent != NO_PARENT; n = nodes[n].parent) {
+        moves.push_back({nodes[n].car, nodes[n].delta});
+    }
+    std::reverse(moves.begin(), moves.end());
+    return moves;
+}
+
+std::vector<StateKey> trace_keys(const NodeArena<SearchNode>& nodes, std::uint32_t goal) {
+    std::vector<StateKey> keys;
+    for (std::uint32_t n = goal; n != NO_PARENT; n = nodes[n].parent) keys.push_back(nodes[n].key);
+    std::reverse(keys.begin(), keys.end());
+    return keys;
+}
+
+std::vector<CompactMove> compact_moves(const Game& g, const std::vector<std::vector<int>>& moves) {
+    std::vector<CompactMove> out;
+    out.reserve(moves.size());
+    StateKey key = g.key();
+    for (const auto& m : moves) {
+        if (m.size() < 2 || m[0] < 0 || m[0] >= g.nbCars) break;
+        int from = key.get(m[0]);
+        int to = from + m[1];
+        if (to < 0 || to + g.lengths[m[0]] > g.size) break;
+        key.set(m[0], to);
+        out.push_back({static_cast<std::uint8_t>(m[0]), static_cast<std::uint8_t>(from), static_cast<std::uint8_t>(to)});
+    }
+    return out;
+}
+
+// ======== Breadth-first search ======== //
+// The arena doubles as the FIFO queue: nodes are appended in BFS order and
+// `head` walks over them.
+template <typename Board>
+static std::vector<std::vector<int>> bfs(const Game& g, SearchWorkspace& ws, SearchStats* stats,
+                                         std::vector<StateKey>* path_keys) {
+    Board board;
+    if (!board.load(g)) return {};
+    NodeArena<SearchNode>& nodes = ws.nodes;
+    FlatKeySet& visited = ws.visited;
+    nodes.reset();
+    visited.clear();
+    visited.reserve(1024);
+    nodes.push_back({board.key(), NO_PARENT, 0, 0});
+    visited.insert(nodes[0].key);
+
+    SearchProbe probe;
+    probe.child(0, true);
+    int depth = 0;
+    std::uint32_t level_end = 1;
+    std::uint32_t head = 0;
+    for (; head < nodes.size(); head++) {
+        if (head == level_end) {
+            depth++;
+            level_end = static_cast<std::uint32_t>(nodes.size());
+        }
+        StateKey key = nodes[head].key;
+        board.load_key(key);
+        if (board.success()) break;
+
+        probe.expand();
+        auto expansion = probe.time(Phase::Expand);
+        board.for_each_child(key, [&](const StateKey& child, int i, int d) {
+            bool fresh;
+            {
+                auto hashing = probe.time(Phase::Hashing);
+                fresh = visited.insert(child);
+            }
+            probe.child(depth + 1, fresh);
+            if (!fresh) return;
+            auto queue = probe.time(Phase::Queue);
+            nodes.push_back({child, head, static_cast<std::int8_t>(i), static_cast<std::int8_t>(d)});
+        });
+    }
+    if (stats) {
+        stats->expanded = head;
+        stats->stored = nodes.size();
+        stats->memory_bytes = nodes.memory_bytes() + visited.memory_bytes();
+        probe.finish(visited.load_factor(), stats->counters);
+    }
+    if (head == nodes.size()) return {};
+    if (path_keys) *path_keys = trace_keys(nodes, head);
+    return trace_moves(nodes, head);
+}
+
+std::vector<std::vector<int>> bfs_shortest_path(const Game& g, SearchStats* stats, std::vector<StateKey>* path_keys,
+                                                SearchWorkspace* workspace) {
+    SearchWorkspace local;
+    SearchWorkspace& ws = workspace ? *workspace : local;
+    return with_board_type(g, [&](auto board) {
+        return bfs<typename decltype(board)::type>(g, ws, stats, path_keys);
+    });
+}
+
+// ======== A* ======== //
+// Nodes live in the arena with their g and h; `index` maps every generated
+// state to its node so a cheaper path updates the node in place (decrease-key
+// in the bucket queue). A closed node reached more cheaply is reopened, which
+// keeps the search optimal for admissible but inconsistent heuristics.
+template <typename Board, typename Estimate>
+static std::vector<std::vector<int>> astar(const Game& g, Estimate estimate, SearchWorkspace& ws, SearchStats* stats) {
+    Board board;
+    if (!board.load(g)) return {};
+    NodeArena<SearchNode>& nodes = ws.nodes;
+    NodeArena<AStarInfo>& info = ws.info;
+    FlatKeyMap<std::uint32_t>& index = ws.index;
+    BucketQueue& open = ws.open;
+    nodes.reset();
+    info.reset();
+    index.clear();
+    index.reserve(1024);
+    open.clear();
+
+    int h0 = estimate(board);
+    nodes.push_back({board.key(), NO_PARENT, 0, 0});
+    info.push_back({0, static_cast<std::uint8_t>(h0)});
+    index.insert(nodes[0].key, 0);
+    open.push(0, h0);
+
+    SearchProbe probe;
+    probe.child(0, true);
+    std::size_t expanded = 0;
+    std::uint32_t goal = NO_PARENT;
+    while (!open.empty()) {
+        std::uint32_t n;
+        {
+            auto queue = probe.time(Phase::Queue);
+            n = open.pop();
+        }
+        StateKey key = nodes[n].key;
+        board.load_key(key);
+        if (board.success()) {
+            goal = n;
+            break;
+        }
+        expanded++;
+
+        probe.expand();
+        auto expansion = probe.time(Phase::Expand);
+        int child_g = info[n].g + 1;
+        // The estimate needs the child's board, so the slides are collected
+        // first and applied to `board` one at a time.
+        Move moves[MAX_MOVES];
+        int nb_moves = board.collect_moves(moves);
+        for (int k = 0; k < nb_moves; k++) {
+            int i = moves[k].car;
+            int d = moves[k].delta;
+            StateKey child = key;
+            child.set(i, board.pos[i] + d);
+            std::pair<std::uint32_t*, bool> res;
+            {
+                auto hashing = probe.time(Phase::Hashing);
+                res = index.insert(child, static_cast<std::uint32_t>(nodes.size()));
+            }
+            probe.child(child_g, res.second);
+            if (res.second) {
+                board.move(i, d);
+                int h = estimate(board);
+                board.move(i, -d);
+                auto queue = probe.time(Phase::Queue);
+                nodes.push_back({child, n, moves[k].car, moves[k].delta});
+                info.push_back({static_cast<std::uint16_t>(child_g), static_cast<std::uint8_t>(h)});
+                open.push(static_cast<std::uint32_t>(nodes.size() - 1), child_g + h);
+            } else {
+                std::uint32_t m = *res.first;
+                if (child_g >= info[m].g) continue;
+                nodes[m].parent = n;
+                nodes[m].car = moves[k].car;
+                nodes[m].delta = moves[k].delta;
+                info[m].g = static_cast<std::uint16_t>(child_g);
+                auto queue = probe.time(Phase::Queue);
+                open.decrease(m, child_g + info[m].h);
+            }
+        }
+    }
+    if (stats) {
+        stats->expanded = expanded;
+        stats->stored = nodes.size();
+        stats->memory_bytes = nodes.memory_bytes() + info.memory_bytes() + index.memory_bytes();
+        probe.finish(index.load_factor(), stats->counters);
+    }
+    if (goal == NO_PARENT) return {};
+    return trace_moves(nodes, goal);
+}
+
+std::vector<std::vector<int>> astar_shortest_path(const Game& g, Heuristic heuristic, SearchStats* stats,
+                                                  SearchWorkspace* workspace) {
+    SearchWorkspace local;
+    SearchWorkspace& ws = workspace ? *workspace : local;
+    auto estimate = [heuristic](const auto& board) { return heuristic_value(board, heuristic); };
+    return with_board_type(g, [&](auto board) {
+        return astar<typename decltype(board)::type>(g, estimate, ws, stats);
+    });
+}
+
+// ======== Pattern databases ======== //
+PatternDatabase* pattern_database_for(const Game& g, SearchWorkspace& workspace) {
+    if (!workspace.pdb_file.empty() && workspace.pdb_file.attach(g)) return &workspace.pdb_file;
+    auto& built = workspace.pdb_built;
+    for (std::size_t k = 0; k < built.size(); k++) {
+        if (!built[k]->has_pattern_of(g) || !built[k]->attach(g)) continue;
+        std::rotate(built.begin() + k, built.begin() + k + 1, built.end());
+        return built.back().get();
+    }
+    auto pdb = std::make_unique<PatternDatabase>();
+    if (!pdb->build(g)) return nullptr;
+    if (built.size() == SearchWorkspace::MAX_BUILT_PDBS) built.erase(built.begin());
+    built.push_back(std::move(pdb));
+    return built.back().get();
+}
+
+// The database bound and the recursive blocking bound are both admissible, and
+// so is their maximum (the latter sees the cars the pattern leaves out).
+std::vector<std::vector<int>> astar_shortest_path(const Game& g, PatternDatabase& pdb, SearchStats* stats,
+                                                  SearchWorkspace* workspace) {
+    if (!pdb.attach(g) && !pdb.build(g)) return {};
+    SearchWorkspace local;
+    SearchWorkspace& ws = workspace ? *workspace : local;
+    auto estimate = [&pdb](const auto& board) {
+        return std::max(pdb.lookup(board), heuristic_value(board, Heuristic::RecursiveBlocking));
+    };
+    return with_board_type(g, [&](auto board) {
+        return astar<typename decltype(board)::type>(g, estimate, ws, stats);
+    });
+}
+
+std::vector<std::vector<int>> astar_shortest_path(const Game& g, const std::string& method, SearchStats* stats,
+                                                  SearchWorkspace* workspace) {
+    if (method == "pattern_database") {
+        SearchWorkspace local;
+        SearchWorkspace& ws = workspace ? *workspace : local;
+        PatternDatabase* pdb = pattern_database_for(g, ws);
+        if (!pdb) return {};
+        return astar_shortest_path(g, *pdb, stats, &ws);
+    }
+    Heuristic heuristic = Heuristic::Trivial;
+    parse_heuristic(method, heuristic);
+    return astar_shortest_path(g, heuristic, stats, workspace);
+}
+
+// ======== Solver by name ======== //
+bool is_solver_name(const std::string& solver) {
+    Heuristic heuristic;
+    if (solver == "bfs" || solver == "bidirectional" || solver == "external") return true;
+    std::string method;
+    if (solver.compare(0, 6, "astar:") == 0) method = solver.substr(6);
+    else if (solver.compare(0, 8, "idastar:") == 0) method = solver.substr(8);
+    else return false;
+    return method == "pattern_database" || parse_heuristic(method, heuristic);
+}
+
+std::vector<std::vector<int>> solve(const Game& g, const std::string& solver, SearchStats* stats,
+                                    std::size_t max_memory, SearchWorkspace* workspace) {
+    if (solver == "bidirectional") return bidirectional_shortest_path(g, stats);
+    if (solver == "external") {
+        std::error_code ec;
+        std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+        return external_bfs_shortest_path(g, ec ? "/tmp" : tmp.string(), max_memory, stats);
+    }
+    if (solver.compare(0, 6, "astar:") == 0) return astar_shortest_path(g, solver.substr(6), stats, workspace);
+    if (solver.compare(0, 8, "idastar:") == 0) {
+        return ida_star_shortest_path(g, solver.substr(8), max_memory, stats, workspace);
+    }
+    return bfs_shortest_path(g, stats, nullptr, workspace);
+}
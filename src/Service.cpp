@@ -0,0 +1,305 @@
+#include "Service.hpp"
+#include "Batch.hpp"
+#include "Game.hpp"
+#include "PuzzleIO.hpp"
+#include "Search.hpp"
+#include "State.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// ======== Clients ======== //
+// Where the answers of one input go: a stream, or a socket connection closed
+// once its last answer is written. Workers write whole lines under the lock.
+class Client {
+public:
+    explicit Client(std::ostream& out) : out(&out) {}
+    explicit Client(int fd) : fd(fd) {}
+    ~Client() {
+        if (fd >= 0) close(fd);
+    }
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    void write_line(const std::string& line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (out) {
+            *out << line << '\n' << std::flush;
+            return;
+        }
+        std::string data = line + '\n';
+        for (std::size_t sent = 0; sent < data.size();) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return; // the client went away
+            sent += n;
+        }
+    }
+
+private:
+    std::ostream* out = nullptr;
+    int fd = -1;
+    std::mutex mutex;
+};
+
+struct Request {
+    std::string id;
+    std::string solver;
+    std::string text;  // the puzzle lines
+    std::string error; // set when the header is malformed
+    std::shared_ptr<Client> client;
+};
+
+// ======== Worker pool ======== //
+// Workers take requests in arrival order. Each owns a SearchWorkspace for its
+// whole life, so the node arena and visited tables are allocated once per
+// worker rather than once per request. submit() blocks while the queue is
+// full, which keeps a fast producer from buffering unbounded input.
+class WorkerPool {
+public:
+    explicit WorkerPool(const ServiceOptions& options)
+        : options(options), max_queued(4 * static_cast<std::size_t>(std::max(1, options.jobs))) {
+        for (int t = 0; t < std::max(1, options.jobs); t++) workers.emplace_back([this]() { work(); });
+    }
+
+    ~WorkerPool() { finish(); }
+
+    void submit(Request r) {
+        std::unique_lock<std::mutex> lock(mutex);
+        room.wait(lock, [&]() { return queue.size() < max_queued; });
+        queue.push_back(std::move(r));
+        ready.notify_one();
+    }
+
+    // Serves what is queued, then stops the workers.
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        ready.notify_all();
+        for (auto& th : workers) th.join();
+        workers.clear();
+    }
+
+    int invalid() const { return invalid_requests; }
+
+private:
+    const ServiceOptions& options;
+    std::size_t max_queued;
+    std::vector<std::thread> workers;
+    std::deque<Request> queue;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable room;
+    bool closed = false;
+    std::atomic<int> invalid_requests{0};
+
+    void work() {
+        SearchWorkspace workspace;
+        if (!options.pdb_path.empty()) workspace.pdb_file.open(options.pdb_path);
+        for (;;) {
+            Request r;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&]() { return closed || !queue.empty(); });
+                if (queue.empty()) return;
+                r = std::move(queue.front());
+                queue.pop_front();
+            }
+            room.notify_one();
+            r.client->write_line(answer(r, workspace));
+        }
+    }
+
+    std::string answer(const Request& r, SearchWorkspace& workspace) {
+        std::string solver = r.solver.empty() ? options.solver : r.solver;
+        std::ostringstream line;
+        line << "{\"id\":\"" << json_escape(r.id) << "\",\"solver\":\"" << json_escape(solver) << "\",";
+
+        Game g;
+        std::string error = r.error;
+        if (error.empty() && !is_solver_name(solver)) error = "unknown solver";
+        if (error.empty()) parse_puzzle(r.text, g, &error);
+        if (!error.empty()) {
+            invalid_requests++;
+            line << "\"status\":\"invalid\",\"error\":\"" << json_escape(error) << "\"}";
+            return line.str();
+        }
+
+        SearchStats stats;
+        auto start = std::chrono::steady_clock::now();
+        auto path = solve(g, solver, &stats, options.max_memory ? options.max_memory : IDA_DEFAULT_MEMORY,
+                          &workspace);
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+        // An empty list is also what a board that starts solved returns.
+        State init_state(g);
+        bool solved = !path.empty() || init_state.success();
+        line << "\"status\":\"" << (solved ? "solved" : "unsolvable") << "\",\"moves\":"
+             << (solved ? static_cast<int>(path.size()) : -1) << ",\"solution\":[";
+        const char* separator = "";
+        for (const CompactMove& m : compact_moves(g, path)) {
+            line << separator << '[' << int(m.car) + 1 << ',' << int(m.from) << ',' << int(m.to) << ']';
+            separator = ",";
+        }
+        line << "],\"expanded\":" << stats.expanded
+             << ",\"stored\":" << stats.stored << ",\"memory_bytes\":" << stats.memory_bytes
+             << ",\"time_s\":" << duration.count() << '}';
+        return line.str();
+    }
+};
+
+// ======== Request parsing ======== //
+static bool is_blank(const std::string& line) {
+    return line.find_first_not_of(" \t\r") == std::string::npos;
+}
+
+static bool is_header(const std::string& line) {
+    return line.compare(0, 5, "solve") == 0 && (line.size() == 5 || line[5] == ' ' || line[5] == '\t');
+}
+
+// Reads requests until next_line reports the end of input and queues them
+// for `client`. A request ends after its last car line; a malformed header or
+// car count makes it run to the next header, so one bad request never
+// swallows the following ones.
+static void read_requests(const std::function<bool(std::string&)>& next_line, const std::shared_ptr<Client>& client,
+                          WorkerPool& pool) {
+    std::string line;
+    bool more = next_line(line);
+    while (more) {
+        if (is_blank(line)) {
+            more = next_line(line);
+            continue;
+        }
+        Request r;
+        r.client = client;
+        std::istringstream header(line);
+        std::string word, extra;
+        header >> word >> r.id >> r.solver >> extra;
+        int needed = -1; // non-blank lines in the body, -1 = up to the next header
+        if (!is_header(line) || r.id.empty() || !extra.empty()) {
+            r.error = "expected \"solve ID [SOLVER]\"";
+        } else {
+            needed = 2;
+        }
+
+        int seen = 0;
+        while ((more = next_line(line)) && !is_header(line)) {
+            if (is_blank(line)) continue;
+            r.text += line;
+            r.text += '\n';
+            seen++;
+            if (seen == 2 && needed == 2) {
+                int cars = 0;
+                needed = std::istringstream(line) >> cars && cars > 0 ? 2 + cars : -1;
+            }
+            if (seen == needed) {
+                more = next_line(line);
+                break;
+            }
+        }
+        pool.submit(std::move(r));
+    }
+}
+
+// ======== Entry points ======== //
+int run_service(const ServiceOptions& options, std::istream& in, std::ostream& out) {
+    WorkerPool pool(options);
+    auto client = std::make_shared<Client>(out);
+    read_requests([&](std::string& line) { return static_cast<bool>(std::getline(in, line)); }, client, pool);
+    pool.finish();
+    return pool.invalid();
+}
+
+// Buffered line reader over a connected socket.
+class SocketLines {
+public:
+    explicit SocketLines(int fd) : fd(fd) {}
+
+    bool operator()(std::string& line) {
+        for (;;) {
+            std::size_t eol = buffer.find('\n', start);
+            if (eol != std::string::npos) {
+                line.assign(buffer, start, eol - start);
+                start = eol + 1;
+                return true;
+            }
+            buffer.erase(0, start);
+            start = 0;
+            char chunk[4096];
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                if (buffer.empty()) return false;
+                line.swap(buffer); // last line without a newline
+                buffer.clear();
+                return true;
+            }
+            buffer.append(chunk, n);
+        }
+    }
+
+private:
+    int fd;
+    std::string buffer;
+    std::size_t start = 0;
+};
+
+int run_socket_service(const ServiceOptions& options, const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << path << "\n";
+        return 1;
+    }
+    path.copy(addr.sun_path, path.size());
+    // A socket left by an earlier run is replaced; anything else is kept.
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cerr << "Not a socket, left as it is: " << path << "\n";
+            return 1;
+        }
+        unlink(path.c_str());
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listener, 64) != 0) {
+        std::perror(("Error listening on " + path).c_str());
+        if (listener >= 0) close(listener);
+        return 1;
+    }
+
+    WorkerPool pool(options);
+    for (;;) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno != EINTR && errno != ECONNABORTED) {
+                std::perror("Error accepting a client");
+                std::this_thread::sleep_for(std::chrono::milliseconds(100)); // e.g. out of descriptors
+            }
+            continue;
+        }
+        // The client closes the connection once its last answer is written.
+        std::thread([fd, &pool]() {
+            auto client = std::make_shared<Client>(fd);
+            SocketLines lines(fd);
+            read_requests(std::ref(lines), client, pool);
+        }).detach();
+    }
+}
@@ -0,0 +1,204 @@
+#include "SolutionCache.hpp"
+#include "Bitboard.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char CACHE_MAGIC[8] = "UBSOL01";
+static const std::size_t CACHE_HEADER = 16;
+static const std::size_t CACHE_INITIAL_RECORDS = 1024;
+
+SolutionCache::~SolutionCache() {
+    release();
+}
+
+void SolutionCache::release() {
+    if (mapping) munmap(mapping, mapping_size);
+    if (fd >= 0) ::close(fd);
+    mapping = nullptr;
+    mapping_size = 0;
+    fd = -1;
+    count = 0;
+    index.clear();
+}
+
+SolutionCache::Record* SolutionCache::records() const {
+    return reinterpret_cast<Record*>(static_cast<char*>(mapping) + CACHE_HEADER);
+}
+
+std::size_t SolutionCache::capacity() const {
+    return (mapping_size - CACHE_HEADER) / sizeof(Record);
+}
+
+// ======== File ======== //
+bool SolutionCache::open(const std::string& path) {
+    release();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        release();
+        return false;
+    }
+    std::size_t file_size = st.st_size;
+    bool fresh = file_size == 0;
+    if (fresh) {
+        file_size = CACHE_HEADER + CACHE_INITIAL_RECORDS * sizeof(Record);
+        if (ftruncate(fd, file_size) != 0) {
+            release();
+            return false;
+        }
+    }
+    void* data = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED || file_size < CACHE_HEADER) {
+        if (data != MAP_FAILED) munmap(data, file_size);
+        release();
+        return false;
+    }
+    mapping = data;
+    mapping_size = file_size;
+
+    char* bytes = static_cast<char*>(mapping);
+    if (fresh) std::memcpy(bytes, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    std::uint64_t stored;
+    std::memcpy(&stored, bytes + 8, sizeof(stored));
+    if (std::memcmp(bytes, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || stored > capacity()) {
+        release();
+        return false;
+    }
+    index.reserve(stored);
+    for (std::size_t n = 0; n < stored; n++) {
+        index.insert(fingerprint(records()[n]), static_cast<std::uint32_t>(n));
+    }
+    count = stored;
+    return true;
+}
+
+bool SolutionCache::grow() {
+    std::size_t new_size = CACHE_HEADER + 2 * capacity() * sizeof(Record);
+    if (ftruncate(fd, new_size) != 0) return false;
+    void* data = mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) return false;
+    munmap(mapping, mapping_size);
+    mapping = data;
+    mapping_size = new_size;
+    return true;
+}
+
+// ======== Canonical layouts ======== //
+template <typename Board>
+SolutionCache::Record SolutionCache::canonical(const Board& b) {
+    Record r{};
+    r.size = static_cast<std::uint8_t>(b.size);
+    r.nbCars = static_cast<std::uint8_t>(b.nbCars);
+    std::uint16_t cars[MAX_CARS];
+    for (int i = 0; i < b.nbCars; i++) {
+        cars[i] = static_cast<std::uint16_t>((b.horiz[i] << 15) | (b.lengths[i] << 8) | (b.lane[i] << 4) | b.pos[i]);
+    }
+    std::sort(cars + 1, cars + b.nbCars);
+    for (int i = 0; i < b.nbCars; i++) {
+        r.cars[2 * i] = static_cast<std::uint8_t>(cars[i] >> 8);
+        r.cars[2 * i + 1] = static_cast<std::uint8_t>(cars[i]);
+    }
+    return r;
+}
+
+// Two independent 64-bit hashes of the layout bytes (distance excluded).
+StateKey SolutionCache::fingerprint(const Record& r) {
+    StateKey k;
+    std::uint64_t words[2 * MAX_CARS / 8];
+    std::memcpy(words, r.cars, sizeof(words));
+    k.lo = mix64(r.size | (std::uint64_t(r.nbCars) << 8));
+    k.hi = mix64(k.lo ^ 0x9e3779b97f4a7c15ULL);
+    for (std::uint64_t w : words) {
+        k.lo = mix64(k.lo ^ w);
+        k.hi = mix64(k.hi + w);
+    }
+    return k;
+}
+
+int SolutionCache::find(const Record& r) const {
+    if (!is_open()) return UNKNOWN;
+    const std::uint32_t* n = index.find(fingerprint(r));
+    if (!n) return UNKNOWN;
+    const Record& stored = records()[*n];
+    if (stored.size != r.size || stored.nbCars != r.nbCars || std::memcmp(stored.cars, r.cars, sizeof(r.cars)) != 0) {
+        return UNKNOWN;
+    }
+    return stored.distance;
+}
+
+bool SolutionCache::append(Record r, int distance) {
+    // A distance does not fit in its byte from UNSOLVABLE on; stored anyway it
+    // would read back as "no solution".
+    if (!is_open() || distance < 0 || distance > UNSOLVABLE || find(r) != UNKNOWN) return false;
+    if (count == capacity() && !grow()) return false;
+    r.distance = static_cast<std::uint8_t>(distance);
+    records()[count] = r;
+    index.insert(fingerprint(r), static_cast<std::uint32_t>(count));
+    count++;
+    std::uint64_t stored = count;
+    std::memcpy(static_cast<char*>(mapping) + 8, &stored, sizeof(stored));
+    return true;
+}
+
+int SolutionCache::lookup(const Game& g) const {
+    WideBitboard board;
+    if (!board.load(g)) return UNKNOWN;
+    return find(canonical(board));
+}
+
+bool SolutionCache::insert(const Game& g, int distance) {
+    WideBitboard board;
+    if (!board.load(g)) return false;
+    return append(canonical(board), distance);
+}
+
+// ======== Cached solve ======== //
+template <typename Board>
+std::vector<std::vector<int>> SolutionCache::solve(const Game& g, SearchStats* stats) {
+    Board board;
+    if (!board.load(g)) return {};
+    int distance = find(canonical(board));
+    if (distance == UNKNOWN) {
+        std::vector<StateKey> path;
+        auto moves = bfs_shortest_path(g, stats, &path);
+        if (path.empty()) {
+            append(canonical(board), UNSOLVABLE);
+            return moves;
+        }
+        for (std::size_t k = 0; k < path.size(); k++) {
+            if (path.size() - 1 - k >= UNSOLVABLE) continue; // too far to record
+            board.load_key(path[k]);
+            append(canonical(board), static_cast<int>(path.size() - 1 - k));
+        }
+        return moves;
+    }
+
+    std::vector<std::vector<int>> moves;
+    for (; distance != UNSOLVABLE && distance > 0; distance--) {
+        Move slides[MAX_MOVES];
+        int nb_slides = board.collect_moves(slides);
+        bool stepped = false;
+        for (int k = 0; k < nb_slides && !stepped; k++) {
+            board.move(slides[k].car, slides[k].delta);
+            if (find(canonical(board)) == distance - 1) {
+                moves.push_back({slides[k].car, slides[k].delta});
+                stepped = true;
+            } else {
+                board.move(slides[k].car, -slides[k].delta);
+            }
+        }
+        if (!stepped) return bfs_shortest_path(g, stats); // the file lost a record
+    }
+    return moves;
+}
+
+std::vector<std::vector<int>> SolutionCache::shortest_path(const Game& g, SearchStats* stats) {
+    return with_board_type(g, [&](auto board) {
+        return solve<typename decltype(board)::type>(g, stats);
+    });
+}
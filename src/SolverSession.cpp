@@ -0,0 +1,87 @@
+#include "SolverSession.hpp"
+#include "StateSpace.hpp"
+
+// ======== Session ======== //
+bool SolverSession::start(const Game& g) {
+    Game copy = g;
+    if (!copy.update_free()) return false;
+    current = copy;
+    distance.clear();
+    nb_searches = 0;
+    stats = SearchStats();
+    return true;
+}
+
+bool SolverSession::play(int car, int delta) {
+    if (car < 0 || car >= current.nbCars || delta == 0) return false;
+    bool legal = false;
+    with_board_type(current, [&](auto type) {
+        typename decltype(type)::type b;
+        if (!b.load(current)) return;
+        legal = delta > 0 ? delta <= b.room_after(car) : -delta <= b.room_before(car);
+    });
+    if (legal) current.slide(car, delta);
+    return legal;
+}
+
+int SolverSession::moves_remaining() {
+    int d = lookup();
+    return d == UNSOLVABLE ? -1 : d;
+}
+
+bool SolverSession::best_move(Move& out) {
+    int d = lookup();
+    if (d == 0 || d == UNSOLVABLE) return false;
+    bool found = false;
+    StateKey key = current.key();
+    with_board_type(current, [&](auto type) {
+        typename decltype(type)::type b;
+        if (!b.load(current)) return;
+        b.for_each_child(key, [&](const StateKey& child, int i, int delta) {
+            const std::uint16_t* dc = found ? nullptr : distance.find(child);
+            if (!dc || *dc != d - 1) return;
+            out = {static_cast<std::int8_t>(i), static_cast<std::int8_t>(delta)};
+            found = true;
+        });
+    });
+    return found;
+}
+
+// ======== Distances ======== //
+// Distance of the current layout, searching first if it is not known yet.
+int SolverSession::lookup() {
+    const std::uint16_t* d = distance.find(current.key());
+    if (d) return *d;
+    explore();
+    d = distance.find(current.key());
+    return d ? *d : UNSOLVABLE;
+}
+
+void SolverSession::explore() {
+    nb_searches++;
+    stats = SearchStats();
+    if (nb_searches == 1) {
+        StateSpace space;
+        if (enumerate_state_space(current, space, max_states) && space.max_distance < StateSpace::UNSOLVABLE - 1) {
+            distance.reserve(space.keys.size());
+            for (std::size_t n = 0; n < space.keys.size(); n++) {
+                std::uint8_t d = space.distance[n];
+                distance.insert(space.keys[n], d == StateSpace::UNSOLVABLE ? UNSOLVABLE : d);
+            }
+            stats.expanded = space.keys.size();
+            stats.stored = space.keys.size();
+            stats.memory_bytes = space.memory_bytes;
+            return;
+        }
+    }
+    // Too many layouts to label them all, or too far apart for StateSpace:
+    // label the solution of a BFS from here.
+    std::vector<StateKey> path;
+    bfs_shortest_path(current, &stats, &path, &workspace);
+    if (path.empty()) {
+        distance.insert(current.key(), UNSOLVABLE);
+        return;
+    }
+    int length = static_cast<int>(path.size()) - 1;
+    for (int i = 0; i <= length; i++) *distance.insert(path[i]).first = static_cast<std::uint16_t>(length - i);
+}
@@ -1,4 +1,7 @@
 #include "State.hpp"
+#include "Bitboard.hpp"
+#include "Search.hpp"
+#include "SolutionCache.hpp"
 #include <iostream>
 #include <queue>
 #include <unordered_set>
@@ -27,15 +30,12 @@ bool State::operator==(const State& other) const {
 }
 
 // ======= Heuristic update ======= //
+// Same heuristics as the A* solver (see Heuristics.hpp); unknown names give 0.
 void State::update_heuristic(std::string method) {
-    if (method == "blocking") {
-        int blocks = 0;
-        int row = G.positions[0][1] - 1;
-        int col_end = G.positions[0][0] - 1 + G.lengths[0];
-        for (int c = col_end; c < G.size; ++c) {
-            if (!G.free[row][c]) blocks++;
-        }
-        h_value = blocks;
+    Heuristic heuristic;
+    WideBitboard board;
+    if (parse_heuristic(method, heuristic) && board.load(G)) {
+        h_value = heuristic_value(board, heuristic);
     } else {
         h_value = 0;
     }
@@ -62,129 +62,71 @@ bool State::succeed() {
 void State::showState() {
     for (int r = 0; r < G.size; r++) {
         for (int c = 0; c < G.size; c++) {
-            std::cout << (G.free[r][c] ? "." : "#");
+            std::cout << (G.is_free(r, c) ? "." : "#");
         }
         std::cout << "\n";
     }
     std::cout << "Moves: " << moves << "\n";
 }
 
-// ======= State expansion helpers ======= //
-void State::states_in_direction(std::unordered_set<State, State::StateHash>& result, int i, bool right) {
-    int step = right ? 1 : -1;
-    Game new_game = G;
-    while (true) {
-        if (G.horiz[i]) {
-            int new_col = new_game.positions[i][0] - 1 + step;
-            int end_col = new_col + new_game.lengths[i] - 1;
-            if (new_col < 0 || end_col >= G.size) break;
-            if (!G.free[new_game.positions[i][1] - 1][right ? end_col : new_col]) break;
-            new_game.positions[i][0] += step;
-        } else {
-            int new_row = new_game.positions[i][1] - 1 + step;
-            int end_row = new_row + new_game.lengths[i] - 1;
-            if (new_row < 0 || end_row >= G.size) break;
-            if (!G.free[right ? end_row : new_row][new_game.positions[i][0] - 1]) break;
-            new_game.positions[i][1] += step;
-        }
-        if (!new_game.update_free()) break;
-        State new_state(new_game, moves + 1, all_moves);
-        new_state.all_moves.push_back({i, step});
-        result.insert(new_state);
-    }
+// ======= State expansion ======= //
+int State::collect_moves(Move* out) const {
+    int n = 0;
+    for_each_move([&](int i, int d) { out[n++] = {static_cast<std::int8_t>(i), static_cast<std::int8_t>(d)}; });
+    return n;
 }
 
-void State::states_in_direction_with_heuristic(std::unordered_set<State, State::StateHash>& result, int i, bool right, std::string method) {
-    int step = right ? 1 : -1;
+// The state reached by sliding car i by delta, with the move recorded in the
+// {car, delta} format of all_moves.
+State State::child(int i, int delta) const {
     Game new_game = G;
-    while (true) {
-        if (G.horiz[i]) {
-            int new_col = new_game.positions[i][0] - 1 + step;
-            int end_col = new_col + new_game.lengths[i] - 1;
-            if (new_col < 0 || end_col >= G.size) break;
-            if (!G.free[new_game.positions[i][1] - 1][right ? end_col : new_col]) break;
-            new_game.positions[i][0] += step;
-        } else {
-            int new_row = new_game.positions[i][1] - 1 + step;
-            int end_row = new_row + new_game.lengths[i] - 1;
-            if (new_row < 0 || end_row >= G.size) break;
-            if (!G.free[right ? end_row : new_row][new_game.positions[i][0] - 1]) break;
-            new_game.positions[i][1] += step;
-        }
-        if (!new_game.update_free()) break;
-        State new_state(new_game, moves + 1, all_moves);
-        new_state.all_moves.push_back({i, step});
-        new_state.update_heuristic(method);
-        result.insert(new_state);
-    }
+    new_game.slide(i, delta);
+    State new_state(new_game, moves + 1, all_moves);
+    new_state.all_moves.push_back({i, delta});
+    return new_state;
 }
 
 // ======= Generate next states ======= //
+// Compatibility wrappers over for_each_move: one full State per child.
 std::unordered_set<State, State::StateHash> State::next_States() {
     std::unordered_set<State, State::StateHash> result;
-    for (int i = 0; i < G.nbCars; ++i) {
-        states_in_direction(result, i, true);
-        states_in_direction(result, i, false);
-    }
+    for_each_move([&](int i, int d) { result.insert(child(i, d)); });
     return result;
 }
 
 std::unordered_set<State, State::StateHash> State::next_States_with_heuristic(std::string method) {
     std::unordered_set<State, State::StateHash> result;
-    for (int i = 0; i < G.nbCars; ++i) {
-        states_in_direction_with_heuristic(result, i, true, method);
-        states_in_direction_with_heuristic(result, i, false, method);
-    }
+    for_each_move([&](int i, int d) {
+        State new_state = child(i, d);
+        new_state.update_heuristic(method);
+        result.insert(new_state);
+    });
     return result;
 }
 
 // ======= Shortest path ======= //
+// Both searches run on packed keys in a node arena (see Search.hpp) and only
+// build the move list for the goal they reach.
 std::vector<std::vector<int>> State::shortest_path() {
-    std::queue<State> q;
-    std::unordered_set<State, State::StateHash> visited;
-    q.push(*this);
-    visited.insert(*this);
-
-    while (!q.empty()) {
-        State cur = q.front();
-        q.pop();
-
-        if (cur.success()) {
-            return cur.all_moves;
-        }
-
-        for (const auto& next : cur.next_States()) {
-            if (!visited.count(next)) {
-                visited.insert(next);
-                q.push(next);
-            }
-        }
-    }
-    return {};
+    return bfs_shortest_path(G);
 }
 
-std::vector<std::vector<int>> State::shortest_path_with_heuristic(std::string method) {
-    auto cmp = [](const State& a, const State& b) { return a < b; };
-    std::priority_queue<State, std::vector<State>, decltype(cmp)> pq(cmp);
-    std::unordered_set<State, State::StateHash> visited;
-
-    pq.push(*this);
+std::vector<std::vector<int>> State::shortest_path(int threads, SearchStats* stats) {
+    return parallel_bfs_shortest_path(G, threads, stats);
+}
 
-    while (!pq.empty()) {
-        State cur = pq.top();
-        pq.pop();
+std::vector<std::vector<int>> State::shortest_path(SolutionCache& cache) {
+    return cache.shortest_path(G);
+}
 
-        if (cur.success()) {
-            return cur.all_moves;
-        }
+std::vector<std::vector<int>> State::shortest_path_with_heuristic(std::string method, SearchStats* stats) {
+    return astar_shortest_path(G, method, stats);
+}
 
-        visited.insert(cur);
+std::vector<std::vector<int>> State::shortest_path_ida(std::string method, std::size_t max_memory) {
+    return ida_star_shortest_path(G, method, max_memory);
+}
 
-        for (const auto& next : cur.next_States_with_heuristic(method)) {
-            if (!visited.count(next)) {
-                pq.push(next);
-            }
-        }
-    }
-    return {};
+std::vector<std::vector<int>> State::shortest_path_bidirectional() {
+    return bidirectional_shortest_path(G);
 }
@@ -0,0 +1,100 @@
+#include "StateSpace.hpp"
+#include "Bitboard.hpp"
+#include "FlatKeyMap.hpp"
+#include <sstream>
+
+// ======== Enumeration ======== //
+template <typename Board>
+static bool enumerate(const Game& g, StateSpace& space, std::size_t max_states) {
+    Board board;
+    if (!board.load(g)) return false;
+    space.keys.clear();
+    space.distance.clear();
+    space.solved = 0;
+    space.max_distance = -1;
+    FlatKeyMap<std::uint32_t> index;
+
+    // Pass 1: the connected component of g.
+    space.keys.push_back(board.key());
+    index.insert(space.keys[0], 0);
+    for (std::size_t head = 0; head < space.keys.size(); head++) {
+        if (space.keys.size() > max_states) return false;
+        StateKey key = space.keys[head];
+        board.load_key(key);
+        board.for_each_child(key, [&](const StateKey& child, int, int) {
+            if (index.insert(child, static_cast<std::uint32_t>(space.keys.size())).second) {
+                space.keys.push_back(child);
+            }
+        });
+    }
+
+    // Pass 2: distances from every solved layout. `order` lists states by
+    // increasing distance and is filled as they are reached.
+    space.distance.assign(space.keys.size(), StateSpace::UNSOLVABLE);
+    std::vector<std::uint32_t> order;
+    for (std::uint32_t n = 0; n < space.keys.size(); n++) {
+        board.load_key(space.keys[n]);
+        if (!board.success()) continue;
+        space.distance[n] = 0;
+        order.push_back(n);
+    }
+    space.solved = order.size();
+    for (std::size_t head = 0; head < order.size(); head++) {
+        std::uint32_t n = order[head];
+        int d = space.distance[n] + 1;
+        if (d >= StateSpace::UNSOLVABLE) d = StateSpace::UNSOLVABLE - 1;
+        StateKey key = space.keys[n];
+        board.load_key(key);
+        board.for_each_child(key, [&](const StateKey& child, int, int) {
+            std::uint32_t m = *index.find(child);
+            if (space.distance[m] != StateSpace::UNSOLVABLE) return;
+            space.distance[m] = static_cast<std::uint8_t>(d);
+            order.push_back(m);
+        });
+    }
+    if (!order.empty()) space.max_distance = space.distance[order.back()];
+    space.memory_bytes = space.keys.capacity() * sizeof(StateKey) + space.distance.capacity() +
+                         order.capacity() * sizeof(std::uint32_t) + index.memory_bytes();
+    return true;
+}
+
+bool enumerate_state_space(const Game& g, StateSpace& space, std::size_t max_states) {
+    return with_board_type(g, [&](auto board) {
+        return enumerate<typename decltype(board)::type>(g, space, max_states);
+    });
+}
+
+std::vector<std::size_t> StateSpace::histogram() const {
+    std::vector<std::size_t> counts(max_distance + 1, 0);
+    for (std::uint8_t d : distance) {
+        if (d != UNSOLVABLE) counts[d]++;
+    }
+    return counts;
+}
+
+// ======== Output ======== //
+std::vector<Game> hardest_layouts(const Game& g, const StateSpace& space, std::size_t limit) {
+    std::vector<Game> layouts;
+    if (space.max_distance < 0) return layouts;
+    for (std::size_t n = 0; n < space.keys.size() && layouts.size() < limit; n++) {
+        if (space.distance[n] == space.max_distance) layouts.push_back(layout_from_key(g, space.keys[n]));
+    }
+    return layouts;
+}
+
+Game layout_from_key(const Game& g, const StateKey& k) {
+    Game layout = g;
+    for (int i = 0; i < g.nbCars; i++) layout.positions[i][g.horiz[i] ? 0 : 1] = k.get(i) + 1;
+    layout.update_free();
+    return layout;
+}
+
+std::string board_text(const Game& g) {
+    std::ostringstream out;
+    out << g.size << "\n" << g.nbCars << "\n";
+    for (int i = 0; i < g.nbCars; i++) {
+        out << i + 1 << " " << (g.horiz[i] ? 'h' : 'v') << " " << g.lengths[i] << " "
+            << g.positions[i][0] << " " << g.positions[i][1] << "\n";
+    }
+    return out.str();
+}
@@ -1,6 +1,16 @@
 // main.cpp
 #include "Game.hpp"
 #include "State.hpp"
+#include "Search.hpp"
+#include "PatternDatabase.hpp"
+#include "Batch.hpp"
+#include "StateSpace.hpp"
+#include "SolutionCache.hpp"
+#include "PuzzleIO.hpp"
+#include "Service.hpp"
+#include "OptimalPaths.hpp"
+#include "SolverSession.hpp"
+#include "Generator.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -8,27 +18,87 @@
 #include <chrono>
 #include <vector>
 #include <string>
+#include <sstream>
+#include <cstring>
+#include <thread>
+#include <cstdlib>
+#include <algorithm>
 
 // ======== Helper: Select Heuristics ======== //
 std::vector<std::string> get_heuristic_selection() {
-    std::vector<std::string> heuristic_methods = { "trivial", "blocking_cars", "distance_to_exit" };
+    std::vector<std::string> heuristic_methods = { "trivial", "blocking_cars", "distance_to_exit", "recursive_blocking",
+                                                   "pattern_database" };
     std::vector<std::string> selected_heuristics;
     std::string input;
     std::cout << "Choose heuristics to apply (1 for yes, 0 for no):" << std::endl;
     std::cout << "1. trivial" << std::endl;
     std::cout << "2. blocking_cars" << std::endl;
     std::cout << "3. distance_to_exit" << std::endl;
-    std::cout << "Enter a 3-digit code (e.g., '101'): ";
+    std::cout << "4. recursive_blocking" << std::endl;
+    std::cout << "5. pattern_database" << std::endl;
+    std::cout << "Enter a 5-digit code (e.g., '10100'): ";
     std::cin >> input;
     // Basic validation (if user entered fewer chars, we avoid UB)
-    for (int i = 0; i < 3 && i < static_cast<int>(input.size()); ++i) {
+    for (int i = 0; i < 5 && i < static_cast<int>(input.size()); ++i) {
         if (input[i] == '1') selected_heuristics.push_back(heuristic_methods[i]);
     }
     return selected_heuristics;
 }
 
+// ======== Helper: Database File ======== //
+std::string database_file(int i) {
+    return (i < 10) ? ("data/GameP0" + std::to_string(i) + ".txt") : ("data/GameP" + std::to_string(i) + ".txt");
+}
+
+// ======== Helper: Solve with a Heuristic ======== //
+// "pattern_database" uses the database mapped with --pdb when the board's
+// pattern matches, and otherwise builds one in memory, kept for the next
+// boards of the same pattern (see pattern_database_for).
+// With --max-memory the search is IDA* within that budget instead of A*.
+static SearchWorkspace pdb_workspace;
+static std::size_t max_memory = 0;
+
+std::vector<std::vector<int>> solve_with_heuristic(State& init_state, const std::string& method, SearchStats* stats) {
+    if (method == "pattern_database") {
+        if (max_memory) return ida_star_shortest_path(init_state.G, method, max_memory, stats, &pdb_workspace);
+        return astar_shortest_path(init_state.G, method, stats, &pdb_workspace);
+    }
+    if (max_memory) return ida_star_shortest_path(init_state.G, method, max_memory, stats);
+    return init_state.shortest_path_with_heuristic(method, stats);
+}
+
+// ======== Helper: Solve without Heuristics ======== //
+// Cache mapped with --cache; when open it answers known layouts and records
+// new solutions, otherwise the BFS runs on `threads` workers.
+static SolutionCache solution_cache;
+
+std::vector<std::vector<int>> solve_plain(State& init_state, int threads, SearchStats* stats) {
+    if (solution_cache.is_open()) return init_state.shortest_path(solution_cache);
+    return init_state.shortest_path(threads, stats);
+}
+
+// ======== Helper: Search Counters ======== //
+// Builds with -DUNBLOCKME_INSTRUMENT print what the solver did (see
+// Instrumentation.hpp) after every solve.
+void print_counters(const SearchStats& stats) {
+    if (INSTRUMENTED) std::cout << "Search counters: " << stats.counters.to_json() << "\n";
+}
+
+// ======== Helper: Solution Output ======== //
+// One line per move: the car and where it stops, as "car >> (x,y)" with the
+// car numbers and coordinates of the puzzle files (both from 1).
+void print_path(const Game& g, const std::vector<std::vector<int>>& shortest_path) {
+    std::cout << "Shortest path:\n";
+    for (const CompactMove& m : compact_moves(g, shortest_path)) {
+        int x = g.horiz[m.car] ? m.to + 1 : g.positions[m.car][0];
+        int y = g.horiz[m.car] ? g.positions[m.car][1] : m.to + 1;
+        std::cout << m.car + 1 << " >> (" << x << "," << y << ")\n";
+    }
+    std::cout << "Number of moves: " << shortest_path.size() << "\n";
+}
+
 // ======== Run on a Specific Board ======== //
-void run_on_specific_board() {
+void run_on_specific_board(int threads) {
     std::string board_data;
     int use_heuristics;
     std::cout << "Enter the board game data (multiple lines allowed). Finish with an empty line or EOF:" << std::endl;
@@ -56,8 +126,9 @@ void run_on_specific_board() {
     if (use_heuristics) {
         auto selected_heuristics = get_heuristic_selection();
         for (const auto& method : selected_heuristics) {
+            SearchStats stats;
             auto start = std::chrono::high_resolution_clock::now();
-            auto shortest_path = init_state.shortest_path_with_heuristic(method);
+            auto shortest_path = solve_with_heuristic(init_state, method, &stats);
             auto end = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> duration = end - start;
 
@@ -65,37 +136,31 @@ void run_on_specific_board() {
             if (shortest_path.empty() || (shortest_path.size() == 1 && shortest_path[0].empty())) {
                 std::cout << "No solution found.\n";
             } else {
-                std::cout << "Shortest path:\n";
-                for (const auto& move : shortest_path) {
-                    if (move.size() >= 3)
-                        std::cout << move[0] << " >> (" << move[1] << "," << move[2] << ")\n";
-                }
-                std::cout << "Number of moves: " << shortest_path.size() << "\n";
+                print_path(init_state.G, shortest_path);
             }
-            std::cout << "Execution time: " << duration.count() << " seconds\n\n";
+            std::cout << "Execution time: " << duration.count() << " seconds\n";
+            print_counters(stats);
+            std::cout << "\n";
         }
     } else {
+        SearchStats stats;
         auto start = std::chrono::high_resolution_clock::now();
-        auto shortest_path = init_state.shortest_path();
+        auto shortest_path = solve_plain(init_state, threads, &stats);
         auto end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> duration = end - start;
 
         if (shortest_path.empty() || (shortest_path.size() == 1 && shortest_path[0].empty())) {
             std::cout << "No solution found.\n";
         } else {
-            std::cout << "Shortest path:\n";
-            for (const auto& move : shortest_path) {
-                if (move.size() >= 3)
-                    std::cout << move[0] << " >> (" << move[1] << "," << move[2] << ")\n";
-            }
-            std::cout << "Number of moves: " << shortest_path.size() << "\n";
+            print_path(init_state.G, shortest_path);
         }
         std::cout << "Execution time: " << duration.count() << " seconds\n";
+        print_counters(stats);
     }
 }
 
 // ======== Run on Database Cases ======== //
-void run_on_database_cases() {
+void run_on_database_cases(int threads) {
     int start_case, end_case;
     char delimiter;
     std::cout << "Enter the range of cases to test (e.g., '4 > 18'): ";
@@ -114,8 +179,7 @@ void run_on_database_cases() {
     if (use_heuristics == 1) selected_heuristics = get_heuristic_selection();
 
     for (int i = start_case; i <= end_case; ++i) {
-        std::string filename = (i < 10) ? ("..data/ExRushHour/GameP0" + std::to_string(i) + ".txt")
-                                        : ("..data/ExRushHour/GameP" + std::to_string(i) + ".txt");
+        std::string filename = database_file(i);
 
         std::ifstream file(filename);
         if (!file) {
@@ -139,8 +203,9 @@ void run_on_database_cases() {
 
             if (use_heuristics == 1) {
                 for (const auto& method : selected_heuristics) {
+                    SearchStats stats;
                     auto start = std::chrono::high_resolution_clock::now();
-                    auto shortest_path = init_state.shortest_path_with_heuristic(method);
+                    auto shortest_path = solve_with_heuristic(init_state, method, &stats);
                     auto end = std::chrono::high_resolution_clock::now();
                     std::chrono::duration<double> duration = end - start;
 
@@ -148,32 +213,26 @@ void run_on_database_cases() {
                     if (shortest_path.empty() || (shortest_path.size() == 1 && shortest_path[0].empty())) {
                         std::cout << "No solution found.\n";
                     } else {
-                        std::cout << "Shortest path:\n";
-                        for (const auto& move : shortest_path) {
-                            if (move.size() >= 3)
-                                std::cout << move[0] << " >> (" << move[1] << "," << move[2] << ")\n";
-                        }
-                        std::cout << "Number of moves: " << shortest_path.size() << "\n";
+                        print_path(init_state.G, shortest_path);
                     }
-                    std::cout << "Execution time: " << duration.count() << " seconds\n\n";
+                    std::cout << "Execution time: " << duration.count() << " seconds\n";
+                    print_counters(stats);
+                    std::cout << "\n";
                 }
             } else {
+                SearchStats stats;
                 auto start = std::chrono::high_resolution_clock::now();
-                auto shortest_path = init_state.shortest_path();
+                auto shortest_path = solve_plain(init_state, threads, &stats);
                 auto end = std::chrono::high_resolution_clock::now();
                 std::chrono::duration<double> duration = end - start;
 
                 if (shortest_path.empty() || (shortest_path.size() == 1 && shortest_path[0].empty())) {
                     std::cout << "No solution found.\n";
                 } else {
-                    std::cout << "Shortest path:\n";
-                    for (const auto& move : shortest_path) {
-                        if (move.size() >= 3)
-                            std::cout << move[0] << " >> (" << move[1] << "," << move[2] << ")\n";
-                    }
-                    std::cout << "Number of moves: " << shortest_path.size() << "\n";
+                    print_path(init_state.G, shortest_path);
                 }
                 std::cout << "Execution time: " << duration.count() << " seconds\n";
+                print_counters(stats);
             }
         } catch (const std::exception& e) {
             std::cerr << "An error occurred while processing file: " << filename << ". Error: " << e.what() << "\n";
@@ -183,19 +242,389 @@ void run_on_database_cases() {
     }
 }
 
+// ======== Compare Solvers ======== //
+// Prints one table row per puzzle and solver in the format of Results/Solver_comparison.txt.
+void compare_solvers() {
+    int start_case, end_case;
+    char delimiter;
+    std::cout << "Enter the range of cases to test (e.g., '4 > 18'): ";
+    std::cin >> start_case >> delimiter >> end_case;
+
+    if (start_case < 1 || end_case < start_case) {
+        std::cerr << "Invalid range. Please ensure the start case is <= end case.\n";
+        return;
+    }
+
+    const std::vector<std::string> solvers = { "bfs", "bidirectional", "astar:trivial", "astar:distance_to_exit",
+                                               "astar:blocking_cars", "astar:recursive_blocking",
+                                               "astar:pattern_database" };
+    std::cout << "Puzzle | Solver | Moves | Expanded | Stored | Time\n";
+    std::cout << "--- | --- | --- | --- | --- | ---\n";
+    for (int i = start_case; i <= end_case; ++i) {
+        std::string filename = database_file(i);
+        std::string name = filename.substr(5, filename.size() - 9);
+        Game g;
+        std::string error;
+        if (!load_puzzle(filename, g, &error)) {
+            std::cerr << "Error reading " << filename << ": " << error << ". Skipping this case.\n";
+            continue;
+        }
+
+        for (const auto& solver : solvers) {
+            SearchStats stats;
+            auto start = std::chrono::high_resolution_clock::now();
+            auto path = solve(g, solver, &stats);
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> duration = end - start;
+
+            std::cout << name << " | " << solver << " | " << path.size() << " | " << stats.expanded << " | "
+                      << stats.stored << " | " << duration.count() << "s\n";
+        }
+    }
+}
+
+// ======== Hardest Layouts ======== //
+// Enumerates everything reachable from the board in `path`, prints the number
+// of layouts at each distance from the exit and the `top` farthest ones, and
+// writes those to out_dir/HardestNN.txt if out_dir is set.
+int run_hardest(const std::string& path, std::size_t top, const std::string& out_dir) {
+    Game g;
+    StateSpace space;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!load_puzzle(path, g) || !enumerate_state_space(g, space)) {
+        std::cerr << "Error reading board: " << path << "\n";
+        return 1;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "Reachable layouts: " << space.keys.size() << " (" << space.solved << " solved, "
+              << space.memory_bytes / 1024 << " kB, " << elapsed.count() << " s)\n";
+    if (space.max_distance < 0) {
+        std::cout << "No reachable layout is solved.\n";
+        return 0;
+    }
+    auto counts = space.histogram();
+    for (int d = 0; d <= space.max_distance; d++) std::cout << "Distance " << d << " : " << counts[d] << "\n";
+
+    auto hardest = hardest_layouts(g, space, top);
+    for (std::size_t k = 0; k < hardest.size(); k++) {
+        std::cout << "\nHardest layout " << k + 1 << " (" << space.max_distance << " moves) :\n" << board_text(hardest[k]);
+        if (out_dir.empty()) continue;
+        std::string name = out_dir + "/Hardest" + (k < 9 ? "0" : "") + std::to_string(k + 1) + ".txt";
+        std::ofstream out(name);
+        out << board_text(hardest[k]);
+        if (!out) {
+            std::cerr << "Error writing: " << name << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// ======== All optimal solutions ======== //
+// Prints the number of optimal solutions of the board in `path` and the first
+// `top` of them, one "car:slide" pair per move (cars numbered from 1, as in
+// the puzzle file).
+int run_solutions(const std::string& path, std::size_t top) {
+    Game g;
+    OptimalPaths paths;
+    SearchStats stats;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!load_puzzle(path, g) || !paths.build(g, &stats)) {
+        std::cerr << "Error reading board: " << path << "\n";
+        return 1;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    if (!paths.solvable()) {
+        std::cout << "No solution.\n";
+        return 0;
+    }
+    std::cout << "Optimal moves: " << paths.length() << "\n";
+    std::cout << "Optimal solutions: " << (paths.overflowed() ? "more than " : "") << paths.count() << " ("
+              << paths.goals() << " solved layouts, " << stats.stored << " layouts searched, "
+              << elapsed.count() << " s)\n";
+    std::size_t k = 0;
+    paths.enumerate(top, [&](const std::vector<Move>& moves) {
+        std::cout << "Solution " << ++k << " :";
+        for (const Move& m : moves) std::cout << ' ' << m.car + 1 << ':' << (m.delta > 0 ? "+" : "") << int(m.delta);
+        std::cout << "\n";
+        return true;
+    });
+    return 0;
+}
+
+// ======== Play session ======== //
+// The board with each cell showing the number of the car on it (as in the
+// puzzle file, from 1) or "." if it is free.
+void show_board(const Game& g) {
+    std::vector<int> cells(g.size * g.size, 0);
+    for (int i = 0; i < g.nbCars; i++) {
+        for (int k = 0; k < g.lengths[i]; k++) {
+            int col = g.positions[i][0] - 1 + (g.horiz[i] ? k : 0);
+            int row = g.positions[i][1] - 1 + (g.horiz[i] ? 0 : k);
+            cells[row * g.size + col] = i + 1;
+        }
+    }
+    for (int r = 0; r < g.size; r++) {
+        for (int c = 0; c < g.size; c++) {
+            int car = cells[r * g.size + c];
+            std::cout << (car ? (car < 10 ? " " : "") + std::to_string(car) : " .") << ' ';
+        }
+        std::cout << "\n";
+    }
+}
+
+// Plays the board in `path` from stdin: "CAR DELTA" slides a car (numbered
+// as in the puzzle file), "hint" shows a best move, "quit" stops. Every
+// answer comes from a SolverSession, so only the first one (or a move off the
+// known layouts) searches.
+int run_play(const std::string& path) {
+    Game g;
+    SolverSession session;
+    if (!load_puzzle(path, g) || !session.start(g)) {
+        std::cerr << "Error reading board: " << path << "\n";
+        return 1;
+    }
+    std::string line;
+    int played = 0;
+    for (;;) {
+        show_board(session.board());
+        std::cout << "Moves played: " << played << "\n";
+        auto start = std::chrono::high_resolution_clock::now();
+        int left = session.moves_remaining();
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        if (left < 0) std::cout << "The exit cannot be reached.";
+        else std::cout << "Moves remaining: " << left;
+        std::cout << " (" << elapsed.count() << " s, " << session.known() << " layouts known)\n";
+        if (left == 0) {
+            std::cout << "Solved in " << played << " moves!\n";
+            return 0;
+        }
+        std::cout << "Move (CAR DELTA), hint or quit: ";
+        if (!std::getline(std::cin, line) || line == "quit") return 0;
+        Move best;
+        int car, delta;
+        if (line == "hint") {
+            if (session.best_move(best)) {
+                std::cout << "Hint: " << best.car + 1 << ' ' << int(best.delta) << "\n";
+            }
+        } else if (!(std::istringstream(line) >> car >> delta) || !session.play(car - 1, delta)) {
+            std::cout << "Illegal move.\n";
+        } else {
+            played++;
+        }
+    }
+}
+
+// ======== Generated puzzles ======== //
+// Writes `count` boards of the generator into the puzzle pack `path` and
+// prints how many there are at each number of moves.
+int run_generate(const GeneratorOptions& options, std::size_t count, const std::string& path) {
+    std::string error = check_generator_options(options);
+    if (!error.empty()) {
+        std::cerr << "Invalid generator options: " << error << "\n";
+        return 1;
+    }
+    std::vector<Game> games;
+    std::vector<int> moves;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!generate_puzzles(options, count, games, &moves)) {
+        std::cerr << "No more boards of " << options.min_moves << " to " << options.max_moves << " moves after "
+                  << options.max_attempts << " attempts (try other sizes, car counts or moves)\n";
+        return 1;
+    }
+    if (!PuzzlePack::write(path, games)) {
+        std::cerr << "Error writing puzzle pack: " << path << "\n";
+        return 1;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "Puzzle pack: " << games.size() << " boards written to " << path << " (seed " << options.seed
+              << ", " << elapsed.count() << " s)\n";
+    std::vector<std::size_t> counts(options.max_moves + 1, 0);
+    for (int m : moves) counts[m]++;
+    for (int m = options.min_moves; m <= options.max_moves; m++) {
+        if (counts[m]) std::cout << "Moves " << m << " : " << counts[m] << "\n";
+    }
+    return 0;
+}
+
 // ======== main ======== //
-int main() {
+// Options: --threads N runs the plain BFS over N workers (0 = all cores).
+//          --pdb FILE maps a pattern database written by --build-pdb.
+//          --cache FILE keeps the BFS solutions in FILE (created if missing).
+//          --progress S prints the search counters every S seconds (instrumented builds).
+//          --max-memory MB solves with IDA* (heuristics, idastar:* solvers) within MB megabytes.
+//          --build-pdb BOARD FILE builds the pattern database of BOARD into FILE and exits.
+//          --batch INPUT... solves puzzle files, directories or globs without prompts
+//            (with --solver NAME, --format json|csv, --jobs N; see Batch.hpp).
+//          --serve reads "solve ID [SOLVER]" requests followed by a puzzle on stdin and
+//            answers each with a JSON line (with --solver, --jobs; see Service.hpp).
+//          --serve-socket PATH serves the same requests on a Unix domain socket.
+//          --solutions BOARD counts the optimal solutions of BOARD and prints the first
+//            ones (as many as --top N).
+//          --play BOARD plays BOARD from stdin with the moves left and hints after each move.
+//          --make-pack FILE INPUT... writes the boards of INPUT into a puzzle pack and exits.
+//          --generate N FILE writes N random boards into a puzzle pack (with --size, --cars,
+//            --min-moves, --max-moves, --seed, --max-states, --jobs; see Generator.hpp).
+//          --hardest BOARD lists the layouts reachable from BOARD that are farthest
+//            from the exit (with --top N, --out DIR).
+int main(int argc, char* argv[]) {
+    int threads = 1;
+    BatchOptions batch;
+    bool batch_mode = false;
+    bool serve_mode = false;
+    std::string serve_socket;
+    std::string hardest_board, hardest_dir, solutions_board, play_board;
+    std::size_t hardest_top = 5;
+    GeneratorOptions generator;
+    std::string generate_path;
+    std::size_t generate_count = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0) {
+            batch_mode = true;
+            while (i + 1 < argc && argv[i + 1][0] != '-') batch.inputs.push_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--serve") == 0) {
+            serve_mode = true;
+        } else if (std::strcmp(argv[i], "--serve-socket") == 0 && i + 1 < argc) {
+            serve_mode = true;
+            serve_socket = argv[++i];
+        } else if (std::strcmp(argv[i], "--solver") == 0 && i + 1 < argc) {
+            batch.solver = argv[++i];
+        } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            batch.format = argv[++i];
+        } else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            batch.jobs = std::atoi(argv[++i]);
+            if (batch.jobs <= 0) batch.jobs = std::max(1u, std::thread::hardware_concurrency());
+        } else if (std::strcmp(argv[i], "--hardest") == 0 && i + 1 < argc) {
+            hardest_board = argv[++i];
+        } else if (std::strcmp(argv[i], "--play") == 0 && i + 1 < argc) {
+            play_board = argv[++i];
+        } else if (std::strcmp(argv[i], "--solutions") == 0 && i + 1 < argc) {
+            solutions_board = argv[++i];
+        } else if (std::strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            hardest_top = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            hardest_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--generate") == 0 && i + 2 < argc) {
+            generate_count = std::strtoull(argv[++i], nullptr, 10);
+            generate_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            generator.size = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--cars") == 0 && i + 1 < argc) {
+            generator.cars = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--min-moves") == 0 && i + 1 < argc) {
+            generator.min_moves = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-moves") == 0 && i + 1 < argc) {
+            generator.max_moves = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            generator.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--max-states") == 0 && i + 1 < argc) {
+            generator.max_states = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+            if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        } else if (std::strcmp(argv[i], "--pdb") == 0 && i + 1 < argc) {
+            if (!pdb_workspace.pdb_file.open(argv[++i])) {
+                std::cerr << "Error opening pattern database: " << argv[i] << "\n";
+                return 1;
+            }
+            batch.pdb_path = argv[i];
+        } else if (std::strcmp(argv[i], "--progress") == 0 && i + 1 < argc) {
+            set_progress_interval(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--max-memory") == 0 && i + 1 < argc) {
+            max_memory = std::strtoull(argv[++i], nullptr, 10) << 20;
+            if (!max_memory) {
+                std::cerr << "Invalid memory budget: " << argv[i] << "\n";
+                return 1;
+            }
+            batch.max_memory = max_memory;
+        } else if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            if (!solution_cache.open(argv[++i])) {
+                std::cerr << "Error opening solution cache: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--build-pdb") == 0 && i + 2 < argc) {
+            PatternDatabase pdb;
+            Game g;
+            std::string error;
+            if (!load_puzzle(argv[i + 1], g, &error) || !pdb.build(g, std::uint64_t(1) << 24, &error) ||
+                !pdb.save(argv[i + 2])) {
+                std::cerr << "Error building pattern database for: " << argv[i + 1]
+                          << (error.empty() ? "" : " (" + error + ")") << "\n";
+                return 1;
+            }
+            std::cout << "Pattern database: " << pdb.entries() << " entries written to " << argv[i + 2] << "\n";
+            return 0;
+        } else if (std::strcmp(argv[i], "--make-pack") == 0 && i + 2 < argc) {
+            std::string pack_path = argv[++i];
+            std::vector<std::string> inputs;
+            while (i + 1 < argc && argv[i + 1][0] != '-') inputs.push_back(argv[++i]);
+            std::vector<Game> games;
+            for (const auto& path : expand_inputs(inputs)) {
+                Game g;
+                std::string error;
+                if (!load_puzzle(path, g, &error)) {
+                    std::cerr << "Error reading " << path << ": " << error << "\n";
+                    return 1;
+                }
+                games.push_back(g);
+            }
+            if (!PuzzlePack::write(pack_path, games)) {
+                std::cerr << "Error writing puzzle pack: " << pack_path << "\n";
+                return 1;
+            }
+            std::cout << "Puzzle pack: " << games.size() << " boards written to " << pack_path << "\n";
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    if (!generate_path.empty()) {
+        generator.jobs = batch.jobs;
+        return run_generate(generator, generate_count, generate_path);
+    }
+    if (!hardest_board.empty()) return run_hardest(hardest_board, hardest_top, hardest_dir);
+    if (!solutions_board.empty()) return run_solutions(solutions_board, hardest_top);
+    if (!play_board.empty()) return run_play(play_board);
+
+    if (serve_mode) {
+        if (!is_solver_name(batch.solver)) {
+            std::cerr << "Unknown solver: " << batch.solver << "\n";
+            return 1;
+        }
+        ServiceOptions service;
+        service.solver = batch.solver;
+        service.jobs = batch.jobs;
+        service.max_memory = batch.max_memory;
+        service.pdb_path = batch.pdb_path;
+        if (!serve_socket.empty()) return run_socket_service(service, serve_socket);
+        run_service(service, std::cin, std::cout);
+        return 0;
+    }
+
+    if (batch_mode) {
+        if (!is_solver_name(batch.solver) || (batch.format != "json" && batch.format != "csv")) {
+            std::cerr << "Unknown solver or format: " << batch.solver << " / " << batch.format << "\n";
+            return 1;
+        }
+        return run_batch(batch, std::cout) == 0 ? 0 : 2;
+    }
+
     int choice;
     std::cout << "Choose how to run the program:\n";
     std::cout << "0 - Run on a specific board\n";
     std::cout << "1 - Run on cases from the database\n";
-    std::cout << "Enter your choice (0 or 1): ";
+    std::cout << "2 - Compare the solvers on cases from the database\n";
+    std::cout << "Enter your choice (0, 1 or 2): ";
     std::cin >> choice;
 
     if (choice == 0) {
-        run_on_specific_board();
+        run_on_specific_board(threads);
     } else if (choice == 1) {
-        run_on_database_cases();
+        run_on_database_cases(threads);
+    } else if (choice == 2) {
+        compare_solvers();
     } else {
         std::cout << "Invalid choice. Exiting...\n";
     }